@@ -0,0 +1,30 @@
+#include "batch_predict.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// Predicting 100 copies of car_eval from one flat matrix, sharded over range(0) threads.
+static void BM_PredictBatch(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    std::vector<std::vector<int>> rows;
+    for (int copy = 0; copy < 100; ++copy)
+    {
+        rows.insert(rows.end(), row_data.begin(), row_data.end());
+    }
+    const auto flat = flatten_rows(rows);
+    std::vector<int> out(rows.size());
+
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        predict_batch(tree, flat, 6, out, pool);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows.size()));
+}
+
+BENCHMARK(BM_PredictBatch)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
@@ -0,0 +1,57 @@
+#include "bitmap.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Building on range(1) rows of binary-labelled data whose eight attributes take 2-5 values, with the index engine (0)
+// or the bitmap engine (1).
+static void BM_BuildTreeEngine(benchmark::State &state)
+{
+    const auto rows = static_cast<size_t>(state.range(1));
+    std::mt19937 gen(8);
+    std::vector<std::vector<int>> row_data(rows, std::vector<int>(8));
+    std::vector<int> target(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t col = 0; col < row_data[i].size(); ++col)
+        {
+            row_data[i][col] = static_cast<int>(gen() % (2 + col % 4));
+        }
+        target[i] = gen() % 10 == 0 ? static_cast<int>(gen() % 2) : (row_data[i][0] + row_data[i][2] * row_data[i][5]) % 2;
+    }
+
+    TrainingContext ctx(row_data, target);
+    BitmapContext bitmaps(row_data, target);
+    for (auto _ : state)
+    {
+        auto tree = state.range(0) == 1 ? build_tree(bitmaps, 100) : build_tree(ctx, 100);
+        benchmark::DoNotOptimize(tree);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+}
+
+// The bundled datasets on each engine; the bitmap engine with the portable kernel (1) and the best one available (2).
+static void BM_BuildTreeEngineBundled(benchmark::State &state)
+{
+    const auto &dataset = bundled_datasets[static_cast<size_t>(state.range(0))];
+    const auto [row_data, target] = dataset.load();
+    state.SetLabel(std::string(dataset.name));
+
+    TrainingContext ctx(row_data, target);
+    BitmapContext bitmaps(row_data, target);
+    if (state.range(1) == 1)
+    {
+        bitmaps.set_kernel(PopcountKernel::Scalar);
+    }
+    for (auto _ : state)
+    {
+        auto tree = state.range(1) > 0 ? build_tree(bitmaps) : build_tree(ctx);
+        benchmark::DoNotOptimize(tree);
+    }
+}
+
+BENCHMARK(BM_BuildTreeEngine)->ArgsProduct({{0, 1}, {10'000, 1'000'000}});
+BENCHMARK(BM_BuildTreeEngineBundled)->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}});
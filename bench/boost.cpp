@@ -0,0 +1,49 @@
+#include "batch_predict.hpp"
+#include "boost.hpp"
+#include "datasets.hpp"
+#include <benchmark/benchmark.h>
+
+// Boosting range(0) rounds of depth-2 trees on car_eval, all on one reweighted context.
+static void BM_BoostTrain(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const BoostOptions options{.rounds = static_cast<int>(state.range(0)), .max_depth = 2};
+
+    for (auto _ : state)
+    {
+        auto ensemble = boost_trees(row_data, target_data, options);
+        benchmark::DoNotOptimize(ensemble);
+    }
+}
+
+// Predicting car_eval with a 50-round ensemble row by row (0) or in blocks with the vectorised vote (1).
+static void BM_BoostPredict(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto ensemble = boost_trees(row_data, target_data, {.rounds = 50, .max_depth = 2});
+    const auto flat = flatten_rows(row_data);
+    const size_t width = row_data.front().size();
+    std::vector<int> out(row_data.size());
+
+    for (auto _ : state)
+    {
+        if (state.range(0) == 1)
+        {
+            ensemble.predict_batch(flat, width, out);
+        }
+        else
+        {
+            for (size_t i = 0; i < row_data.size(); ++i)
+            {
+                out[i] = ensemble.predict(row_data[i]);
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * row_data.size()));
+    state.counters["trees"] = static_cast<double>(ensemble.size());
+}
+
+BENCHMARK(BM_BoostTrain)->Arg(10)->Arg(50);
+BENCHMARK(BM_BoostPredict)->DenseRange(0, 1);
@@ -0,0 +1,39 @@
+#include "bulk_score.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+
+// Parsing and scoring 200 copies of car_eval as csv with range(0) worker threads, output discarded.
+static void BM_BulkScoreCsv(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    std::string csv;
+    for (int copy = 0; copy < 200; ++copy)
+    {
+        for (size_t i = 0; i < row_data.size(); ++i)
+        {
+            for (int v : row_data[i])
+            {
+                csv += std::to_string(v) + ',';
+            }
+            csv += std::to_string(target_data[i]) + '\n';
+        }
+    }
+
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    std::ostream discard(nullptr);
+    for (auto _ : state)
+    {
+        auto rows = bulk_score(csv, tree, discard, pool, {.chunk_bytes = 1 << 18});
+        benchmark::DoNotOptimize(rows);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * csv.size()));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 200 * row_data.size()));
+}
+
+BENCHMARK(BM_BulkScoreCsv)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
@@ -30,6 +30,34 @@ static void BM_BuildTree(benchmark::State &state)
     }
 }
 
+static void BM_BuildTreeReuse(benchmark::State &state)
+{
+    constexpr int cols = 7;
+    io::CSVReader<cols> in(file);
+    int buying, maint, doors, person, lug_boot, safety, class_;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(buying, maint, doors, person, lug_boot, safety, class_))
+    {
+        row_data.push_back({buying, maint, doors, person, lug_boot, safety});
+        target_data.push_back(class_);
+    }
+
+    auto [train_set, _] = train_test_split(row_data, target_data, 0.8);
+    auto &[train_data, train_target] = train_set;
+
+    TrainingContext ctx(train_data, train_target);
+
+    for (auto _ : state)
+    {
+        ctx.select_all();
+        auto tree = build_tree(ctx);
+        benchmark::DoNotOptimize(tree);
+    }
+}
+
 static void BM_TreePredict(benchmark::State &state)
 {
     constexpr int cols = 7;
@@ -118,8 +146,7 @@ static void BM_TreePredict2(benchmark::State &state)
 }
 
 BENCHMARK(BM_BuildTree);
+BENCHMARK(BM_BuildTreeReuse);
 BENCHMARK(BM_BuildTree2);
 BENCHMARK(BM_TreePredict);
 BENCHMARK(BM_TreePredict2);
-
-BENCHMARK_MAIN();
@@ -0,0 +1,48 @@
+#include "counting_sort.hpp"
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Sorting a node of range(1) rows, scattered over a column four times its size, by keys taking range(0) distinct
+// values, with the single-histogram scalar kernel (0) or the interleaved one (1).
+static void BM_CountingSort(benchmark::State &state)
+{
+    const auto cardinality = static_cast<int>(state.range(0));
+    const auto n = static_cast<size_t>(state.range(1));
+
+    std::mt19937 gen(4);
+    std::vector<int> col_data(n * 4);
+    for (auto &v : col_data)
+    {
+        v = static_cast<int>(gen() % static_cast<unsigned>(cardinality));
+    }
+    std::vector<int> rows(col_data.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::shuffle(rows.begin(), rows.end(), gen);
+    rows.resize(n);
+    std::ranges::sort(rows);
+
+    std::vector<int> idxs(n), output(n), keys(n);
+    std::vector<int> count(counting_sort_lanes * static_cast<size_t>(cardinality));
+    for (auto _ : state)
+    {
+        // Both kernels pay for restoring the unsorted window.
+        std::ranges::copy(rows, idxs.begin());
+
+        if (state.range(2) == 1)
+        {
+            counting_sort_interleaved(col_data.data(), idxs.data(), n, count.data(), keys.data(), output.data());
+        }
+        else
+        {
+            counting_sort_scalar(col_data.data(), idxs.data(), n, count.data(), output.data());
+        }
+        benchmark::DoNotOptimize(idxs.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+BENCHMARK(BM_CountingSort)->ArgNames({"keys", "rows", "kernel"})->ArgsProduct({{2, 5, 8, 16, 64}, {64, 1024, 16384, 262144}, {0, 1}});
@@ -0,0 +1,28 @@
+#include "criteria.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+template <typename Criterion>
+static void BM_BuildTreeCriterion(benchmark::State &state)
+{
+    const auto &bundled = bundled_datasets[static_cast<size_t>(state.range(0))];
+    auto [row_data, target_data] = bundled.load();
+
+    TrainingContext ctx(row_data, target_data);
+
+    size_t nodes = 0;
+    for (auto _ : state)
+    {
+        auto tree = build_tree<Criterion>(ctx);
+        benchmark::DoNotOptimize(tree);
+        nodes = count_nodes(tree);
+    }
+
+    state.SetLabel(std::string(bundled.name));
+    state.counters["nodes"] = static_cast<double>(nodes);
+}
+
+BENCHMARK_TEMPLATE(BM_BuildTreeCriterion, Entropy)->DenseRange(0, bundled_datasets.size() - 1);
+BENCHMARK_TEMPLATE(BM_BuildTreeCriterion, GainRatio)->DenseRange(0, bundled_datasets.size() - 1);
+BENCHMARK_TEMPLATE(BM_BuildTreeCriterion, Gini)->DenseRange(0, bundled_datasets.size() - 1);
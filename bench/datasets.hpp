@@ -0,0 +1,90 @@
+#pragma once
+
+#include "csv.h"
+
+#include <array>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using RowsAndTarget = std::pair<std::vector<std::vector<int>>, std::vector<int>>;
+
+inline RowsAndTarget load_tennis_data()
+{
+    io::CSVReader<5> in("../datasets/tennis.csv");
+    int outlook, temp, humidity, wind, play;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(outlook, temp, humidity, wind, play))
+    {
+        row_data.push_back({outlook, temp, humidity, wind});
+        target_data.push_back(play);
+    }
+    return {row_data, target_data};
+}
+
+inline RowsAndTarget load_car_data()
+{
+    io::CSVReader<7> in("../datasets/car_eval.csv");
+    int f1, f2, f3, f4, f5, f6, target;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(f1, f2, f3, f4, f5, f6, target))
+    {
+        row_data.push_back({f1, f2, f3, f4, f5, f6});
+        target_data.push_back(target);
+    }
+    return {row_data, target_data};
+}
+
+inline RowsAndTarget load_mushroom_data()
+{
+    io::CSVReader<23> in("../datasets/mushroom.csv");
+    int label;
+    int f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(label, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22))
+    {
+        row_data.push_back({f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22});
+        target_data.push_back(label);
+    }
+    return {row_data, target_data};
+}
+
+inline RowsAndTarget load_zoo_data()
+{
+    io::CSVReader<17> in("../datasets/zoo.csv");
+    int label;
+    int f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, label))
+    {
+        row_data.push_back({f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16});
+        target_data.push_back(label);
+    }
+    return {row_data, target_data};
+}
+
+struct BundledDataset
+{
+    std::string_view name;
+    RowsAndTarget (*load)();
+};
+
+// Benchmarks that sweep the bundled datasets take the index into this table as their argument.
+inline constexpr std::array<BundledDataset, 4> bundled_datasets = {{
+    {"tennis", load_tennis_data},
+    {"car_eval", load_car_data},
+    {"mushroom", load_mushroom_data},
+    {"zoo", load_zoo_data},
+}};
@@ -0,0 +1,26 @@
+#include "datasets.hpp"
+#include "distributed.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// Mushroom repeated 16 times, about 130k rows, built in one process (0) or sharded over that many forked workers. The
+// workers only run side by side with as many cores free.
+static void BM_BuildTreeForked(benchmark::State &state)
+{
+    const auto [mushroom_rows, mushroom_target] = load_mushroom_data();
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    for (int copy = 0; copy < 16; ++copy)
+    {
+        row_data.insert(row_data.end(), mushroom_rows.begin(), mushroom_rows.end());
+        target_data.insert(target_data.end(), mushroom_target.begin(), mushroom_target.end());
+    }
+
+    for (auto _ : state)
+    {
+        auto tree = state.range(0) == 0 ? build_tree(row_data, target_data) : build_tree_forked(row_data, target_data, static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(tree);
+    }
+}
+
+BENCHMARK(BM_BuildTreeForked)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
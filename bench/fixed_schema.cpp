@@ -0,0 +1,48 @@
+#include "datasets.hpp"
+#include "fixed_schema.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Retraining a small per-customer model: 64 different samples of range(1) car_eval rows, each built with the generic
+// builder on a reused context (0) or with a reused fixed-schema builder (1).
+static void BM_BuildTreeFixedSchema(benchmark::State &state)
+{
+    const auto [car_rows, car_target] = load_car_data();
+    const auto rows_per_model = static_cast<size_t>(state.range(1));
+
+    std::mt19937 gen(9);
+    std::vector<std::pair<std::vector<std::vector<int>>, std::vector<int>>> samples(64);
+    for (auto &[rows, target] : samples)
+    {
+        for (size_t i = 0; i < rows_per_model; ++i)
+        {
+            const auto row = gen() % car_rows.size();
+            rows.push_back(car_rows[row]);
+            target.push_back(car_target[row]);
+        }
+    }
+
+    TrainingContext ctx;
+    FixedSchemaBuilder<6, 3, 4> builder;
+    size_t s = 0;
+    for (auto _ : state)
+    {
+        const auto &[rows, target] = samples[s];
+        if (state.range(0) == 1)
+        {
+            auto tree = builder.build(rows, target);
+            benchmark::DoNotOptimize(tree);
+        }
+        else
+        {
+            ctx.assign(rows, target);
+            auto tree = build_tree(ctx);
+            benchmark::DoNotOptimize(tree);
+        }
+        s = (s + 1) % samples.size();
+    }
+}
+
+BENCHMARK(BM_BuildTreeFixedSchema)->ArgsProduct({{0, 1}, {50, 200, 1728}});
@@ -0,0 +1,61 @@
+#include "batch_predict.hpp"
+#include "datasets.hpp"
+#include "hot_path.hpp"
+#include "packed_tree.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Skewed traffic over 256 car_eval models, each trained on its own bootstrap sample and queried in turn: 95% of
+// lookups are drawn from 16 rows, the rest from anywhere. Predicted by the Node trees as built (0) or reordered on a
+// traffic sample (1), and packed breadth first (2) or reordered and packed along the hot paths (3).
+static void BM_TreePredictSkewed(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto mode = state.range(0);
+
+    std::mt19937 gen(13);
+    std::vector<std::vector<int>> traffic;
+    for (int i = 0; i < 20'000; ++i)
+    {
+        const auto row = gen() % 20 == 0 ? gen() % row_data.size() : (gen() % 16) * 97 % row_data.size();
+        traffic.push_back(row_data[row]);
+    }
+    const auto sample = flatten_rows({traffic.begin(), traffic.begin() + 2000});
+
+    TrainingContext ctx(row_data, target_data);
+    std::vector<Node> trees;
+    std::vector<PackedTree> packed;
+    for (int m = 0; m < 256; ++m)
+    {
+        std::vector<int> rows(row_data.size());
+        for (auto &row : rows)
+        {
+            row = static_cast<int>(gen() % row_data.size());
+        }
+        ctx.select(rows);
+        auto tree = build_tree(ctx);
+        if (mode == 1 || mode == 3)
+        {
+            reorder_by_traffic(tree, sample, row_data.front().size());
+        }
+        packed.emplace_back(tree, mode == 3 ? PackedLayout::HotPath : PackedLayout::BreadthFirst);
+        trees.push_back(std::move(tree));
+    }
+
+    size_t m = 0;
+    for (auto _ : state)
+    {
+        for (const auto &row : traffic)
+        {
+            auto pred = mode >= 2 ? packed[m].predict(row) : tree_predict(row, trees[m]);
+            benchmark::DoNotOptimize(pred);
+            m = (m + 1) % trees.size();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * traffic.size()));
+}
+
+BENCHMARK(BM_TreePredictSkewed)->DenseRange(0, 3);
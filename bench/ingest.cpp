@@ -0,0 +1,112 @@
+#include "batch_predict.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+// Mushroom repeated 16 times, about 130k rows, as a caller holding one row-major array and one array per column.
+struct CallerTable
+{
+    size_t num_rows = 0;
+    size_t width = 0;
+    std::vector<int> row_major;
+    std::vector<std::vector<int>> col_major;
+    std::vector<int> target;
+};
+
+const CallerTable &caller_table()
+{
+    static const CallerTable table = []
+    {
+        const auto [mushroom_rows, mushroom_target] = load_mushroom_data();
+        CallerTable t;
+        t.width = mushroom_rows[0].size();
+        t.col_major.resize(t.width);
+        for (int copy = 0; copy < 16; ++copy)
+        {
+            for (size_t i = 0; i < mushroom_rows.size(); ++i)
+            {
+                t.row_major.insert(t.row_major.end(), mushroom_rows[i].begin(), mushroom_rows[i].end());
+                for (size_t j = 0; j < t.width; ++j)
+                {
+                    t.col_major[j].push_back(mushroom_rows[i][j]);
+                }
+                t.target.push_back(mushroom_target[i]);
+            }
+        }
+        t.num_rows = t.target.size();
+        return t;
+    }();
+    return table;
+}
+
+std::vector<StridedColumn> columns(const CallerTable &t, bool row_major)
+{
+    std::vector<StridedColumn> cols(t.width);
+    for (size_t j = 0; j < t.width; ++j)
+    {
+        cols[j] = row_major ? StridedColumn{t.row_major.data() + j, t.width} : StridedColumn{t.col_major[j].data()};
+    }
+    return cols;
+}
+} // namespace
+
+// Readying a context from the row-major array: split into nested vectors and assigned (0), or assigned as strided
+// columns (1); and from the column arrays, used in place (2).
+static void BM_IngestColumns(benchmark::State &state)
+{
+    const auto &t = caller_table();
+    TrainingContext ctx;
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            std::vector<std::vector<int>> rows(t.num_rows);
+            for (size_t i = 0; i < t.num_rows; ++i)
+            {
+                rows[i].assign(t.row_major.begin() + static_cast<std::ptrdiff_t>(i * t.width),
+                               t.row_major.begin() + static_cast<std::ptrdiff_t>((i + 1) * t.width));
+            }
+            ctx.assign(rows, t.target);
+        }
+        else
+        {
+            ctx.assign_columns(columns(t, state.range(0) == 1), {t.target.data()}, t.num_rows);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_IngestColumns)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+// Scoring the row-major array: split into rows for tree_predict (0), or read in place by predict_columns (1).
+static void BM_PredictColumns(benchmark::State &state)
+{
+    const auto &t = caller_table();
+    TrainingContext ctx;
+    ctx.assign_columns(columns(t, false), {t.target.data()}, t.num_rows);
+    const auto tree = build_tree(ctx);
+    const auto cols = columns(t, true);
+    std::vector<int> out(t.num_rows);
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            std::vector<std::vector<int>> rows(t.num_rows);
+            for (size_t i = 0; i < t.num_rows; ++i)
+            {
+                rows[i].assign(t.row_major.begin() + static_cast<std::ptrdiff_t>(i * t.width),
+                               t.row_major.begin() + static_cast<std::ptrdiff_t>((i + 1) * t.width));
+                out[i] = tree_predict(rows[i], tree);
+            }
+        }
+        else
+        {
+            predict_columns(tree, cols, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+
+BENCHMARK(BM_PredictColumns)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,163 @@
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <bit>
+#include <random>
+
+// One benchmark per training and prediction kernel, over synthetic nodes of every size from a few hundred rows to a
+// million, so a change in build time can be traced to the kernel that caused it. Arguments are the node's rows, the
+// values per attribute and, where the kernel counts labels, the classes. Items are rows unless noted; bytes are what
+// the kernel reads per row: the row index plus the attribute values, labels and weights it looks at.
+
+namespace
+{
+constexpr size_t num_attrs = 6;
+
+// Attributes uniform over [0, cardinality); the label depends on the first two attributes, with 10% noise.
+struct KernelData
+{
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+};
+
+KernelData make_data(size_t num_rows, int cardinality, int classes)
+{
+    std::mt19937 gen(50);
+    std::uniform_int_distribution<int> value(0, cardinality - 1);
+    std::uniform_int_distribution<int> label(0, classes - 1);
+    KernelData data;
+    data.rows.assign(num_rows, std::vector<int>(num_attrs));
+    data.target.resize(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        for (auto &v : data.rows[i])
+        {
+            v = value(gen);
+        }
+        data.target[i] = gen() % 10 == 0 ? label(gen) : (data.rows[i][0] + 3 * data.rows[i][1]) % classes;
+    }
+    return data;
+}
+
+void set_throughput(benchmark::State &state, int64_t items_per_iteration, int64_t bytes_per_item)
+{
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+    state.SetBytesProcessed(state.iterations() * items_per_iteration * bytes_per_item);
+}
+
+const std::vector<int64_t> node_sizes = {256, 4096, 65536, 1 << 20};
+} // namespace
+
+// Dataset::sort_by, alternating between two columns so that every sort starts from an order unrelated to its key.
+static void BM_KernelSortBy(benchmark::State &state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)), static_cast<int>(state.range(1)), 2);
+    TrainingContext ctx(data.rows, data.target);
+    auto ds = ctx.begin_build();
+    size_t col = 0;
+    for (auto _ : state)
+    {
+        ds.sort_by(col);
+        col ^= 1;
+        benchmark::ClobberMemory();
+    }
+    set_throughput(state, state.range(0), 2 * sizeof(int));
+}
+
+BENCHMARK(BM_KernelSortBy)->ArgsProduct({node_sizes, {2, 8, 64}});
+
+// split_entropy on a node already sorted by the attribute.
+static void BM_KernelSplitEntropy(benchmark::State &state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)), static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+    TrainingContext ctx(data.rows, data.target);
+    auto ds = ctx.begin_build();
+    ds.sort_by(0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(split_entropy(ds, 0));
+    }
+    set_throughput(state, state.range(0), 4 * sizeof(int));
+}
+
+BENCHMARK(BM_KernelSplitEntropy)->ArgsProduct({node_sizes, {2, 8, 64}, {2, 8}});
+
+// Dataset::mode_label, the weighted label count every node starts with.
+static void BM_KernelModeLabel(benchmark::State &state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)), 8, static_cast<int>(state.range(1)));
+    TrainingContext ctx(data.rows, data.target);
+    const auto ds = ctx.begin_build();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ds.mode_label());
+    }
+    set_throughput(state, state.range(0), 3 * sizeof(int));
+}
+
+BENCHMARK(BM_KernelModeLabel)->ArgsProduct({node_sizes, {2, 8, 64}});
+
+// Dataset::find_next_label walking every partition of a sorted node, as split_iterator does. Items are partitions;
+// bytes are the row index and value each step of a partition's binary search reads.
+static void BM_KernelFindNextLabel(benchmark::State &state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)), static_cast<int>(state.range(1)), 2);
+    TrainingContext ctx(data.rows, data.target);
+    auto ds = ctx.begin_build();
+    ds.sort_by(0);
+    int64_t partitions = 0;
+    for (auto _ : state)
+    {
+        partitions = 0;
+        for (size_t begin = 0; begin < ds.num_rows(); ++partitions)
+        {
+            begin = ds.find_next_label(0, ds.get_col_sorted(0, begin), begin);
+        }
+        benchmark::DoNotOptimize(partitions);
+    }
+    const auto steps = static_cast<int64_t>(std::bit_width(static_cast<uint64_t>(state.range(0))));
+    set_throughput(state, partitions, steps * static_cast<int64_t>(2 * sizeof(int)));
+}
+
+BENCHMARK(BM_KernelFindNextLabel)->ArgsProduct({node_sizes, {2, 8, 64}});
+
+// Dataset::localize, which copies a node's rows into a compact context of their own; the second argument is how many
+// attributes the node has already split on, which are left out of the copy.
+static void BM_KernelLocalize(benchmark::State &state)
+{
+    const auto data = make_data(static_cast<size_t>(state.range(0)), 8, 2);
+    TrainingContext ctx(data.rows, data.target);
+    const auto ds = ctx.begin_build();
+    std::bitset<64> used;
+    for (int64_t col = 0; col < state.range(1); ++col)
+    {
+        used.set(static_cast<size_t>(col));
+    }
+    for (auto _ : state)
+    {
+        auto local = ds.localize(used);
+        benchmark::DoNotOptimize(local);
+    }
+    const auto copied_cols = static_cast<int64_t>(num_attrs) - state.range(1);
+    set_throughput(state, state.range(0), static_cast<int64_t>(sizeof(int)) * (copied_cols + 3));
+}
+
+BENCHMARK(BM_KernelLocalize)->ArgsProduct({node_sizes, {0, 4}});
+
+// tree_predict on a fully grown tree over the same kind of data. Items are predictions; bytes are the rows.
+static void BM_KernelTreePredict(benchmark::State &state)
+{
+    const auto data = make_data(65536, static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const auto tree = build_tree(data.rows, data.target);
+    for (auto _ : state)
+    {
+        for (const auto &row : data.rows)
+        {
+            benchmark::DoNotOptimize(tree_predict(row, tree));
+        }
+    }
+    set_throughput(state, static_cast<int64_t>(data.rows.size()), static_cast<int64_t>(num_attrs * sizeof(int)));
+    state.counters["nodes"] = static_cast<double>(count_nodes(tree));
+}
+
+BENCHMARK(BM_KernelTreePredict)->ArgsProduct({{2, 8, 64}, {2, 8}});
@@ -0,0 +1,155 @@
+#include "perf_history.hpp"
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// tree_benchmark's entry point: Google Benchmark's, plus keeping a history of runs and comparing against it.
+//
+//   --history=FILE          append every repetition of this run to FILE (see perf_history.hpp)
+//   --history_label=LABEL   what to file the run under; the short hash of the checked-out commit by default
+//   --baseline=LABEL        compare this run with the samples filed under LABEL in the history, or with the most
+//                           recent other label for "previous", and print the comparison table
+//   --min_change=FRACTION   smallest change reported as faster or slower; 0.02 by default
+//   --fail_on_regression    exit with status 2 if any benchmark got slower
+//
+// With --history or --baseline every benchmark runs 10 repetitions unless --benchmark_repetitions says otherwise.
+
+namespace
+{
+class CollectingReporter : public benchmark::ConsoleReporter
+{
+  public:
+    std::vector<PerfSample> samples;
+    std::string label;
+
+    void ReportRuns(const std::vector<Run> &reports) override
+    {
+        for (const auto &run : reports)
+        {
+            if (run.run_type != Run::RT_Iteration || run.error_occurred || run.iterations == 0)
+                continue;
+
+            const auto iterations = static_cast<double>(run.iterations);
+            samples.push_back({label, run.benchmark_name(), run.real_accumulated_time / iterations * 1e9, run.cpu_accumulated_time / iterations * 1e9});
+        }
+        ConsoleReporter::ReportRuns(reports);
+    }
+};
+
+std::string current_commit()
+{
+    std::string hash;
+    if (FILE *git = ::popen("git rev-parse --short HEAD 2>/dev/null", "r"))
+    {
+        char buf[64];
+        while (std::fgets(buf, sizeof(buf), git))
+        {
+            hash += buf;
+        }
+        ::pclose(git);
+    }
+    while (!hash.empty() && (hash.back() == '\n' || hash.back() == '\r'))
+    {
+        hash.pop_back();
+    }
+    return hash.empty() ? "current" : hash;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string history_path;
+    std::string label;
+    std::string baseline;
+    CompareOptions compare_options;
+    bool fail_on_regression = false;
+    bool repetitions_given = false;
+
+    std::vector<char *> args{argv[0]};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const auto value = [&arg](std::string_view flag) { return std::string(arg.substr(flag.size())); };
+        if (arg.starts_with("--history="))
+            history_path = value("--history=");
+        else if (arg.starts_with("--history_label="))
+            label = value("--history_label=");
+        else if (arg.starts_with("--baseline="))
+            baseline = value("--baseline=");
+        else if (arg.starts_with("--min_change="))
+            compare_options.min_change = std::stod(value("--min_change="));
+        else if (arg == "--fail_on_regression")
+            fail_on_regression = true;
+        else
+        {
+            repetitions_given = repetitions_given || arg.starts_with("--benchmark_repetitions=");
+            args.push_back(argv[i]);
+        }
+    }
+
+    std::string repetitions = "--benchmark_repetitions=10";
+    if ((!history_path.empty() || !baseline.empty()) && !repetitions_given)
+    {
+        args.push_back(repetitions.data());
+    }
+    args.push_back(nullptr);
+    int args_count = static_cast<int>(args.size()) - 1;
+
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data()))
+        return 1;
+
+    CollectingReporter reporter;
+    reporter.label = label.empty() ? current_commit() : label;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    int status = 0;
+    try
+    {
+        if (!baseline.empty())
+        {
+            const auto history = history_path.empty() ? std::vector<PerfSample>{} : read_history(history_path);
+            if (baseline == "previous")
+            {
+                baseline = previous_label(history, reporter.label);
+            }
+
+            std::vector<PerfSample> baseline_samples;
+            for (const auto &s : history)
+            {
+                if (s.label == baseline)
+                    baseline_samples.push_back(s);
+            }
+            if (baseline_samples.empty())
+            {
+                std::cerr << "no baseline samples in the history to compare with\n";
+                status = 1;
+            }
+            else
+            {
+                const auto comparisons = compare_runs(baseline_samples, reporter.samples, compare_options);
+                std::cout << '\n';
+                print_comparison(std::cout, comparisons, baseline, reporter.label);
+                const bool regressed = std::ranges::any_of(comparisons, [](const auto &c) { return c.verdict == PerfVerdict::Slower; });
+                if (fail_on_regression && regressed)
+                    status = 2;
+            }
+        }
+
+        if (!history_path.empty())
+        {
+            append_history(history_path, reporter.samples);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return status;
+}
@@ -0,0 +1,100 @@
+#include "datasets.hpp"
+#include "model_handle.hpp"
+#include "serve.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <shared_mutex>
+
+namespace
+{
+class EpochModel
+{
+    ModelHandle<Node> m_handle;
+
+  public:
+    explicit EpochModel(Node tree) : m_handle(std::make_unique<const Node>(std::move(tree))) {}
+
+    auto reader() { return m_handle.reader(); }
+
+    template <typename Reader>
+    static int predict(Reader &reader, std::span<const int> obs)
+    {
+        return tree_predict(obs, *reader.pin());
+    }
+
+    void publish(Node tree) { m_handle.publish(std::make_unique<const Node>(std::move(tree))); }
+};
+
+// The usual alternative: readers share a lock for the duration of a prediction and the writer takes it exclusively
+// to swap the pointer. The old model is destroyed outside the lock.
+class LockedModel
+{
+    std::shared_mutex m_mutex;
+    std::shared_ptr<const Node> m_tree;
+
+  public:
+    explicit LockedModel(Node tree) : m_tree(std::make_shared<const Node>(std::move(tree))) {}
+
+    LockedModel *reader() { return this; }
+
+    static int predict(LockedModel *self, std::span<const int> obs)
+    {
+        std::shared_lock lock(self->m_mutex);
+        return tree_predict(obs, *self->m_tree);
+    }
+
+    void publish(Node tree)
+    {
+        auto next = std::make_shared<const Node>(std::move(tree));
+        std::unique_lock lock(m_mutex);
+        m_tree.swap(next);
+    }
+};
+} // namespace
+
+// Per-prediction latency on car_eval while another thread publishes a fresh copy of the tree every 50us
+// (range(0) == 1) or never (range(0) == 0).
+template <typename Model>
+static void BM_PredictDuringSwap(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    Model model(tree);
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> swaps{0};
+    std::thread writer(
+        [&]
+        {
+            while (state.range(0) && !done)
+            {
+                model.publish(tree);
+                swaps.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+
+    auto reader = model.reader();
+    LatencyHistogram latency;
+    size_t row = 0;
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto pred = Model::predict(reader, row_data[row]);
+        latency.record(std::chrono::steady_clock::now() - start);
+        benchmark::DoNotOptimize(pred);
+        row = row + 1 == row_data.size() ? 0 : row + 1;
+    }
+
+    done = true;
+    writer.join();
+
+    state.counters["p50_ns"] = static_cast<double>(latency.percentile(0.5).count());
+    state.counters["p99_ns"] = static_cast<double>(latency.percentile(0.99).count());
+    state.counters["max_ns"] = static_cast<double>(latency.percentile(1.0).count());
+    state.counters["swaps"] = static_cast<double>(swaps.load());
+}
+
+BENCHMARK(BM_PredictDuringSwap<EpochModel>)->DenseRange(0, 1)->UseRealTime();
+BENCHMARK(BM_PredictDuringSwap<LockedModel>)->DenseRange(0, 1)->UseRealTime();
@@ -0,0 +1,43 @@
+#include "datasets.hpp"
+#include "multi_target.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Eight related models over mushroom: its label with a different 2% of it flipped in each. Built one by one on a
+// reused context (0) or with one multi-target build (1).
+static void BM_BuildTreesMultiTarget(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_mushroom_data();
+    std::mt19937 gen(5);
+    std::vector<std::vector<int>> targets(8, target_data);
+    for (auto &target : targets)
+    {
+        for (auto &label : target)
+        {
+            label = gen() % 50 == 0 ? 1 - label : label;
+        }
+    }
+
+    TrainingContext ctx;
+    for (auto _ : state)
+    {
+        if (state.range(0) == 1)
+        {
+            auto trees = build_trees(row_data, targets);
+            benchmark::DoNotOptimize(trees);
+        }
+        else
+        {
+            for (const auto &target : targets)
+            {
+                ctx.assign(row_data, target);
+                auto tree = build_tree(ctx);
+                benchmark::DoNotOptimize(tree);
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_BuildTreesMultiTarget)->DenseRange(0, 1);
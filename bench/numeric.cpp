@@ -0,0 +1,37 @@
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// A price-like numeric column next to a few categorical ones; the label depends on both.
+static std::pair<std::vector<std::vector<int>>, std::vector<int>> make_numeric_data(size_t nrows)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> price(0, 1'000'000);
+    std::uniform_int_distribution<int> cat(0, 3);
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    for (size_t i = 0; i < nrows; ++i)
+    {
+        const int p = price(gen);
+        const int a = cat(gen);
+        const int b = cat(gen);
+        row_data.push_back({a, b, p});
+        target_data.push_back((p > 250'000 * a) + (b == 2 && p % 7 == 0));
+    }
+    return {row_data, target_data};
+}
+
+static void BM_BuildTreeNumeric(benchmark::State &state)
+{
+    auto [row_data, target_data] = make_numeric_data(static_cast<size_t>(state.range(0)));
+    TrainingContext ctx(row_data, target_data, 0b100);
+
+    for (auto _ : state)
+    {
+        auto tree = build_tree(ctx);
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BuildTreeNumeric)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
@@ -0,0 +1,58 @@
+#include "datasets.hpp"
+#include "packed_tree.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Predicting car_eval rows with range(0) models, each trained on its own bootstrap sample and queried in turn, as a
+// Node tree or packed. The model_bytes counter is what the models take up.
+template <typename Model>
+static void BM_TreePredictModels(benchmark::State &state)
+{
+    const auto [row_data, target_data] = load_car_data();
+    const auto num_models = static_cast<size_t>(state.range(0));
+
+    std::mt19937 gen(3);
+    TrainingContext ctx(row_data, target_data);
+    std::vector<Model> models;
+    size_t model_bytes = 0;
+    for (size_t m = 0; m < num_models; ++m)
+    {
+        std::vector<int> sample(row_data.size());
+        for (auto &row : sample)
+        {
+            row = static_cast<int>(gen() % row_data.size());
+        }
+        ctx.select(sample);
+        const auto tree = build_tree(ctx);
+
+        if constexpr (std::is_same_v<Model, PackedTree>)
+        {
+            models.emplace_back(tree);
+            model_bytes += models.back().size_bytes();
+        }
+        else
+        {
+            models.push_back(tree);
+            model_bytes += count_nodes(tree) * sizeof(Node);
+        }
+    }
+
+    size_t m = 0;
+    for (auto _ : state)
+    {
+        for (const auto &row : row_data)
+        {
+            auto pred = tree_predict(row, models[m]);
+            benchmark::DoNotOptimize(pred);
+            m = m + 1 == num_models ? 0 : m + 1;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * row_data.size()));
+    state.counters["model_bytes"] = static_cast<double>(model_bytes);
+}
+
+BENCHMARK(BM_TreePredictModels<Node>)->RangeMultiplier(8)->Range(1, 512);
+BENCHMARK(BM_TreePredictModels<PackedTree>)->RangeMultiplier(8)->Range(1, 512);
@@ -0,0 +1,29 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// Share of attribute evaluations each shortcut in the split search saves, per bundled dataset.
+static void BM_BuildTreeSkipRates(benchmark::State &state)
+{
+    const auto &bundled = bundled_datasets[static_cast<size_t>(state.range(0))];
+    auto [row_data, target_data] = bundled.load();
+
+    TrainingContext ctx(row_data, target_data);
+
+    BuildStats stats;
+    for (auto _ : state)
+    {
+        stats = {};
+        auto tree = build_tree(ctx, {.stats = &stats});
+        benchmark::DoNotOptimize(tree);
+    }
+
+    const auto evaluations = static_cast<double>(std::max<size_t>(stats.evaluations, 1));
+    state.SetLabel(std::string(bundled.name));
+    state.counters["nodes"] = static_cast<double>(stats.nodes);
+    state.counters["evaluations"] = static_cast<double>(stats.evaluations);
+    state.counters["constant_skip_rate"] = static_cast<double>(stats.constant_skips) / evaluations;
+    state.counters["early_exit_rate"] = static_cast<double>(stats.early_exits) / evaluations;
+}
+
+BENCHMARK(BM_BuildTreeSkipRates)->DenseRange(0, bundled_datasets.size() - 1);
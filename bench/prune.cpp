@@ -0,0 +1,58 @@
+#include "datasets.hpp"
+#include "prune.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// Prediction over held-out car_eval rows with 15% label noise: unpruned (0), reduced-error pruned (1) and
+// cost-complexity pruned with alpha = 0.005 (2).
+static void BM_TreePredictPruned(benchmark::State &state)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    std::mt19937 gen(11);
+    for (auto &t : target_data)
+    {
+        if (gen() % 100 < 15)
+        {
+            t = static_cast<int>(gen() % 4);
+        }
+    }
+
+    std::vector<int> idx(row_data.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    std::shuffle(idx.begin(), idx.end(), gen);
+    const auto ntrain = static_cast<long>(idx.size() * 7 / 10);
+    const std::vector<int> train(idx.begin(), idx.begin() + ntrain);
+    const std::vector<int> holdout(idx.begin() + ntrain, idx.end());
+
+    TrainingContext ctx(row_data, target_data);
+    ctx.select(train);
+    auto tree = build_tree(ctx);
+
+    if (state.range(0) == 1)
+    {
+        prune_reduced_error(tree, ctx, holdout);
+    }
+    else if (state.range(0) == 2)
+    {
+        prune_cost_complexity(tree, 0.005);
+    }
+
+    int correct = 0;
+    for (auto _ : state)
+    {
+        correct = 0;
+        for (int row : holdout)
+        {
+            auto pred = tree_predict(row_data[row], tree);
+            benchmark::DoNotOptimize(pred);
+            correct += pred == target_data[row];
+        }
+    }
+
+    state.counters["nodes"] = static_cast<double>(count_nodes(tree));
+    state.counters["depth"] = static_cast<double>(tree_depth(tree));
+    state.counters["accuracy"] = static_cast<double>(correct) / static_cast<double>(holdout.size());
+}
+
+BENCHMARK(BM_TreePredictPruned)->DenseRange(0, 2);
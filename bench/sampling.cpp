@@ -0,0 +1,41 @@
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+// Building on 500k rows of 16 five-valued attributes whose label follows three of them, with every candidate scored
+// exactly (0) or narrowed on a 4096 row sample in nodes of at least 20k rows (1).
+static void BM_BuildTreeSampled(benchmark::State &state)
+{
+    constexpr size_t rows = 500'000;
+    std::mt19937 gen(9);
+    std::vector<std::vector<int>> row_data(rows, std::vector<int>(16));
+    std::vector<int> target(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (auto &v : row_data[i])
+        {
+            v = static_cast<int>(gen() % 5);
+        }
+        target[i] = gen() % 10 == 0 ? static_cast<int>(gen() % 4) : (row_data[i][3] + row_data[i][7] * (row_data[i][11] > 1)) % 4;
+    }
+
+    TrainingContext ctx(row_data, target);
+    BuildOptions options{.min_samples_split = 1000};
+    if (state.range(0) == 1)
+    {
+        options.sample_threshold = 20'000;
+    }
+
+    size_t nodes = 0;
+    for (auto _ : state)
+    {
+        auto tree = build_tree(ctx, options);
+        nodes = count_nodes(tree);
+        benchmark::DoNotOptimize(tree);
+    }
+
+    state.counters["nodes"] = static_cast<double>(nodes);
+}
+
+BENCHMARK(BM_BuildTreeSampled)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
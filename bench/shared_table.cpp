@@ -0,0 +1,39 @@
+#include "datasets.hpp"
+#include "shared_table.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+// Getting mushroom repeated 16 times, about 130k rows, ready to train on: copied and transposed from row data into a
+// context (0), or attached in place from a published table (1).
+static void BM_PrepareContext(benchmark::State &state)
+{
+    const auto [mushroom_rows, mushroom_target] = load_mushroom_data();
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    for (int copy = 0; copy < 16; ++copy)
+    {
+        row_data.insert(row_data.end(), mushroom_rows.begin(), mushroom_rows.end());
+        target_data.insert(target_data.end(), mushroom_target.begin(), mushroom_target.end());
+    }
+    const auto path = (std::filesystem::temp_directory_path() / "tree_race_shared_table_bench").string();
+    publish_table(path, row_data, target_data);
+
+    for (auto _ : state)
+    {
+        TrainingContext ctx;
+        if (state.range(0) == 1)
+        {
+            attach(ctx, SharedTable::open(path));
+        }
+        else
+        {
+            ctx.assign(row_data, target_data);
+        }
+        benchmark::DoNotOptimize(ctx);
+    }
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(BM_PrepareContext)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
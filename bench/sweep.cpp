@@ -0,0 +1,53 @@
+#include "datasets.hpp"
+#include "sweep.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+
+// Tuning min_samples_split over 8 values on four copies of car_eval, validated on one more: a build and a validation
+// pass per value (0), or sweep_tree (1).
+static void BM_SweepMinSamplesSplit(benchmark::State &state)
+{
+    const auto [car_rows, car_target] = load_car_data();
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    for (int copy = 0; copy < 5; ++copy)
+    {
+        rows.insert(rows.end(), car_rows.begin(), car_rows.end());
+        target.insert(target.end(), car_target.begin(), car_target.end());
+    }
+
+    std::vector<int> train(car_rows.size() * 4);
+    std::iota(train.begin(), train.end(), 0);
+    std::vector<int> validation(car_rows.size());
+    std::iota(validation.begin(), validation.end(), static_cast<int>(train.size()));
+
+    TrainingContext ctx(rows, target);
+    ctx.select(train);
+    const std::vector<SweepConfig> configs{{2}, {4}, {8}, {16}, {32}, {64}, {128}, {256}};
+
+    for (auto _ : state)
+    {
+        if (state.range(0) == 1)
+        {
+            auto sweep = sweep_tree(ctx, configs, validation);
+            benchmark::DoNotOptimize(sweep);
+        }
+        else
+        {
+            for (const auto &config : configs)
+            {
+                const auto tree = build_tree(ctx, config.min_samples_split);
+                int errors = 0;
+                for (const int row : validation)
+                {
+                    errors += tree_predict(rows[static_cast<size_t>(row)], tree) != target[static_cast<size_t>(row)];
+                }
+                benchmark::DoNotOptimize(errors);
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_SweepMinSamplesSplit)->DenseRange(0, 1);
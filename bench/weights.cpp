@@ -0,0 +1,37 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <benchmark/benchmark.h>
+
+// Building on ten copies of car_eval as they are (0) or collapsed to weighted unique rows beforehand (1).
+static void BM_BuildTreeCollapsed(benchmark::State &state)
+{
+    auto [car_rows, car_target] = load_car_data();
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    for (int copy = 0; copy < 10; ++copy)
+    {
+        rows.insert(rows.end(), car_rows.begin(), car_rows.end());
+        target.insert(target.end(), car_target.begin(), car_target.end());
+    }
+
+    TrainingContext ctx;
+    if (state.range(0) == 1)
+    {
+        const auto unique = collapse_duplicates(rows, target);
+        ctx.assign_weighted(unique.rows, unique.target, unique.weights);
+    }
+    else
+    {
+        ctx.assign(rows, target);
+    }
+
+    for (auto _ : state)
+    {
+        auto tree = build_tree(ctx);
+        benchmark::DoNotOptimize(tree);
+    }
+
+    state.counters["rows"] = static_cast<double>(ctx.num_rows());
+}
+
+BENCHMARK(BM_BuildTreeCollapsed)->DenseRange(0, 1);
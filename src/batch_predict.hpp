@@ -0,0 +1,84 @@
+#pragma once
+
+#include "node.hpp"
+#include "thread_pool.hpp"
+#include "tree.hpp"
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Copies equally long rows into one row-major matrix, the layout predict_batch reads.
+inline std::vector<int> flatten_rows(const std::vector<std::vector<int>> &rows)
+{
+    std::vector<int> flat;
+    flat.reserve(rows.empty() ? 0 : rows.size() * rows.front().size());
+    for (const auto &row : rows)
+    {
+        if (row.size() != rows.front().size())
+        {
+            throw std::invalid_argument("rows differ in length");
+        }
+        flat.insert(flat.end(), row.begin(), row.end());
+    }
+    return flat;
+}
+
+// Predicts every `width`-value row of the row-major `observations` into `out`, one label per row, on the calling thread.
+inline void predict_rows(const Node &tree, std::span<const int> observations, size_t width, std::span<int> out)
+{
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        out[i] = tree_predict(observations.subspan(i * width, width), tree);
+    }
+}
+
+// predict_rows sharded over `pool`. Every thread writes one contiguous run of `out` that starts on a cache line, so no
+// two threads ever write to the same line.
+inline void predict_batch(const Node &tree, std::span<const int> observations, size_t width, std::span<int> out, ThreadPool &pool)
+{
+    if (width == 0 || observations.size() % width != 0 || observations.size() / width != out.size())
+    {
+        throw std::invalid_argument("observations do not fill one output per row");
+    }
+    if (width < tree_input_width(tree))
+    {
+        throw std::invalid_argument("rows are narrower than the model's input width");
+    }
+
+    constexpr size_t line_ints = 64 / sizeof(int);
+    const auto misalignment = reinterpret_cast<uintptr_t>(out.data()) % 64 / sizeof(int);
+    const size_t head = std::min(out.size(), misalignment ? line_ints - misalignment : 0);
+    predict_rows(tree, observations.first(head * width), width, out.first(head));
+
+    const auto rest = observations.subspan(head * width);
+    const auto rest_out = out.subspan(head);
+    parallel_for(pool, rest_out.size(), line_ints,
+                 [&](size_t begin, size_t end)
+                 { predict_rows(tree, rest.subspan(begin * width, (end - begin) * width), width, rest_out.subspan(begin, end - begin)); });
+}
+
+// One row of a table held column by column.
+struct ColumnRow
+{
+    std::span<const StridedColumn> cols;
+    size_t row;
+
+    int operator[](size_t col) const { return cols[col][row]; }
+};
+
+// Predicts `out.size()` rows held column by column in caller memory, e.g. the columns of a numpy array or an Arrow
+// table, reading only the values the tree looks at instead of copying rows out first.
+inline void predict_columns(const Node &tree, std::span<const StridedColumn> cols, std::span<int> out)
+{
+    if (cols.size() < tree_input_width(tree))
+    {
+        throw std::invalid_argument("fewer columns than the model's input width");
+    }
+
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        out[i] = tree_predict_at(ColumnRow{cols, i}, tree);
+    }
+}
@@ -0,0 +1,470 @@
+#pragma once
+
+#include "criteria.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// AND + popcount kernels over 64-bit bitmap words, in a portable version and, on x86-64, AVX2 and AVX-512 versions
+// picked at runtime by what the CPU supports.
+enum class PopcountKernel
+{
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+inline bool popcount_kernel_supported(PopcountKernel kernel)
+{
+#if defined(__x86_64__)
+    switch (kernel)
+    {
+    case PopcountKernel::Scalar:
+        return true;
+    case PopcountKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case PopcountKernel::Avx512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+    }
+    return false;
+#else
+    return kernel == PopcountKernel::Scalar;
+#endif
+}
+
+inline PopcountKernel best_popcount_kernel()
+{
+    static const PopcountKernel best = popcount_kernel_supported(PopcountKernel::Avx512) ? PopcountKernel::Avx512
+                                       : popcount_kernel_supported(PopcountKernel::Avx2) ? PopcountKernel::Avx2
+                                                                                         : PopcountKernel::Scalar;
+    return best;
+}
+
+namespace bitmap_kernels
+{
+// With `out` set, also stores a & b into it.
+inline int and_popcount_scalar(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n)
+{
+    int count = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const uint64_t word = a[i] & b[i];
+        if (out)
+            out[i] = word;
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+#if defined(__x86_64__)
+// Nibble lookup popcount: each byte's count is the sum of two table lookups, and sad_epu8 sums the bytes of each lane.
+__attribute__((target("avx2"))) inline int and_popcount_avx2(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256i words = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        if (out)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), words);
+
+        const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(words, low_nibble));
+        const __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(words, 4), low_nibble));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+
+    const auto count = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+    return static_cast<int>(count) + and_popcount_scalar(a + i, b + i, out ? out + i : nullptr, n - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline int and_popcount_avx512(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n)
+{
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < n; i += 8)
+    {
+        const auto mask = static_cast<__mmask8>(n - i >= 8 ? 0xFF : (1u << (n - i)) - 1);
+        const __m512i words = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, a + i), _mm512_maskz_loadu_epi64(mask, b + i));
+        if (out)
+            _mm512_mask_storeu_epi64(out + i, mask, words);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(words));
+    }
+    return static_cast<int>(_mm512_reduce_add_epi64(acc));
+}
+#endif
+} // namespace bitmap_kernels
+
+// Number of bits set in a & b over `n` words; with `out` set, a & b is also stored there.
+inline int and_popcount(PopcountKernel kernel, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *out = nullptr)
+{
+#if defined(__x86_64__)
+    switch (kernel)
+    {
+    case PopcountKernel::Avx512:
+        return bitmap_kernels::and_popcount_avx512(a, b, out, n);
+    case PopcountKernel::Avx2:
+        return bitmap_kernels::and_popcount_avx2(a, b, out, n);
+    case PopcountKernel::Scalar:
+        break;
+    }
+#endif
+    return bitmap_kernels::and_popcount_scalar(a, b, out, n);
+}
+
+// Training data for the bitmap engine: one bitmap of rows per (attribute, value) and one per class, so the class
+// counts of any partition of a node come from ANDing the node's row bitmap with a value and a class bitmap and
+// counting bits. Meant for categorical data with few values per attribute and few classes, where that is far less
+// work than sorting the node's rows; memory grows with the number of distinct values. Rows all weigh one and every
+// attribute is categorical.
+class BitmapContext
+{
+    std::vector<uint64_t> m_bits;
+    std::vector<size_t> m_value_offsets;
+    std::vector<int> m_num_values;
+    size_t m_class_offset = 0;
+    size_t m_num_classes = 0;
+    size_t m_num_rows = 0;
+    size_t m_words = 0;
+    PopcountKernel m_kernel = best_popcount_kernel();
+
+  public:
+    BitmapContext() = default;
+
+    BitmapContext(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target) { assign(row_data, target); }
+
+    void assign(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target)
+    {
+        if (row_data.size() != target.size())
+        {
+            throw std::invalid_argument("one target per row is needed");
+        }
+
+        m_num_rows = row_data.size();
+        // Rounded up to whole AVX-512 registers; the padding bits stay clear.
+        m_words = (m_num_rows + 511) / 512 * 8;
+        const size_t num_attributes = row_data.empty() ? 0 : row_data.front().size();
+
+        m_num_values.assign(num_attributes, 0);
+        for (const auto &row : row_data)
+        {
+            for (size_t col = 0; col < num_attributes; ++col)
+            {
+                m_num_values[col] = std::max(m_num_values[col], row[col] + 1);
+            }
+        }
+        m_num_classes = target.empty() ? 0 : static_cast<size_t>(std::ranges::max(target)) + 1;
+
+        m_value_offsets.resize(num_attributes);
+        size_t offset = 0;
+        for (size_t col = 0; col < num_attributes; ++col)
+        {
+            m_value_offsets[col] = offset;
+            offset += static_cast<size_t>(m_num_values[col]) * m_words;
+        }
+        m_class_offset = offset;
+        m_bits.assign(offset + m_num_classes * m_words, 0);
+
+        for (size_t row = 0; row < m_num_rows; ++row)
+        {
+            const uint64_t bit = uint64_t{1} << (row % 64);
+            for (size_t col = 0; col < num_attributes; ++col)
+            {
+                m_bits[m_value_offsets[col] + static_cast<size_t>(row_data[row][col]) * m_words + row / 64] |= bit;
+            }
+            m_bits[m_class_offset + static_cast<size_t>(target[row]) * m_words + row / 64] |= bit;
+        }
+    }
+
+    size_t num_rows() const { return m_num_rows; }
+
+    size_t num_attributes() const { return m_num_values.size(); }
+
+    size_t num_classes() const { return m_num_classes; }
+
+    size_t num_words() const { return m_words; }
+
+    PopcountKernel kernel() const { return m_kernel; }
+
+    void set_kernel(PopcountKernel kernel)
+    {
+        if (!popcount_kernel_supported(kernel))
+        {
+            throw std::invalid_argument("popcount kernel not supported on this CPU");
+        }
+        m_kernel = kernel;
+    }
+
+    int num_values(size_t col) const { return m_num_values[col]; }
+
+    const uint64_t *value_bits(size_t col, int value) const { return m_bits.data() + m_value_offsets[col] + static_cast<size_t>(value) * m_words; }
+
+    const uint64_t *class_bits(size_t label) const { return m_bits.data() + m_class_offset + label * m_words; }
+};
+
+// id3 over a BitmapContext. Makes the same choices in the same order as id3 over a Dataset, from the same integer
+// counts, so both build identical trees. Sampled split selection is not used. Each node is a row bitmap together with
+// the range of words that can have bits set, which keeps deep, small nodes from scanning the whole bitmap.
+class BitmapBuilder
+{
+    const BitmapContext &m_ctx;
+    const BuildOptions &m_options;
+    // One node bitmap per depth, the root first.
+    std::vector<uint64_t> m_nodes;
+    std::vector<uint64_t> m_partition;
+    std::vector<int> m_value_totals;
+    std::vector<int> m_counts;
+
+    struct Range
+    {
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+  public:
+    BitmapBuilder(const BitmapContext &ctx, const BuildOptions &options)
+        : m_ctx(ctx), m_options(options), m_nodes((ctx.num_attributes() + 1) * ctx.num_words()), m_partition(ctx.num_words()),
+          m_counts(std::max<size_t>(ctx.num_classes(), 1))
+    {
+        int max_values = 0;
+        for (size_t col = 0; col < ctx.num_attributes(); ++col)
+        {
+            max_values = std::max(max_values, ctx.num_values(col));
+        }
+        m_value_totals.resize(static_cast<size_t>(max_values));
+    }
+
+    template <typename Criterion>
+    Node build()
+    {
+        uint64_t *root = m_nodes.data();
+        for (size_t row = 0; row < m_ctx.num_rows(); ++row)
+        {
+            root[row / 64] |= uint64_t{1} << (row % 64);
+        }
+        return id3<Criterion>(0, {0, m_ctx.num_words()}, 0, 0);
+    }
+
+  private:
+    void tally(size_t BuildStats::*counter)
+    {
+        if (m_options.stats)
+            m_options.stats->*counter += 1;
+    }
+
+    const uint64_t *node_bits(size_t depth) const { return m_nodes.data() + depth * m_ctx.num_words(); }
+
+    // Class counts of the rows in `bits` into m_counts; returns their total.
+    int class_counts(const uint64_t *bits, Range range, int total = -1)
+    {
+        const size_t n = range.end - range.begin;
+        const auto kernel = m_ctx.kernel();
+        if (total < 0)
+        {
+            total = and_popcount(kernel, bits + range.begin, bits + range.begin, n);
+        }
+
+        // The last class gets whatever the others leave.
+        int rest = total;
+        for (size_t label = 0; label + 1 < m_ctx.num_classes(); ++label)
+        {
+            m_counts[label] = and_popcount(kernel, bits + range.begin, m_ctx.class_bits(label) + range.begin, n);
+            rest -= m_counts[label];
+        }
+        if (m_ctx.num_classes() > 0)
+        {
+            m_counts[m_ctx.num_classes() - 1] = rest;
+        }
+        return total;
+    }
+
+    // Rows of the node per value of `col` into m_value_totals; returns how many values have rows.
+    int value_totals(size_t depth, Range range, size_t col)
+    {
+        int present = 0;
+        for (int value = 0; value < m_ctx.num_values(col); ++value)
+        {
+            const auto total = and_popcount(m_ctx.kernel(), node_bits(depth) + range.begin, m_ctx.value_bits(col, value) + range.begin, range.end - range.begin);
+            m_value_totals[static_cast<size_t>(value)] = total;
+            present += total > 0;
+        }
+        return present;
+    }
+
+    template <typename Criterion>
+    float split_score(size_t depth, Range range, size_t col, int node_total, float parent_impurity, float bound)
+    {
+        const std::span<const int> class_cnts(m_counts.data(), m_ctx.num_classes());
+        float total_impurity = 0;
+        float split_info = 0;
+
+        int last = m_ctx.num_values(col) - 1;
+        while (m_value_totals[static_cast<size_t>(last)] == 0)
+        {
+            --last;
+        }
+
+        for (int value = 0; value <= last; ++value)
+        {
+            const auto total = m_value_totals[static_cast<size_t>(value)];
+            if (total == 0)
+                continue;
+
+            and_popcount(m_ctx.kernel(), node_bits(depth) + range.begin, m_ctx.value_bits(col, value) + range.begin, range.end - range.begin,
+                         m_partition.data() + range.begin);
+            class_counts(m_partition.data(), range, total);
+            total_impurity += Criterion::impurity(total, class_cnts);
+            if constexpr (Criterion::uses_split_info)
+            {
+                split_info += Criterion::split_info(total, node_total);
+            }
+
+            if constexpr (Criterion::exits_early)
+            {
+                if (value < last && total_impurity >= bound)
+                    return std::numeric_limits<float>::infinity();
+            }
+        }
+
+        return Criterion::score(total_impurity, parent_impurity, split_info);
+    }
+
+    // Shrinks `range` to the whole AVX-512 registers that hold bits of `bits`.
+    Range trim(const uint64_t *bits, Range range) const
+    {
+        while (range.begin < range.end && bits[range.begin] == 0)
+        {
+            ++range.begin;
+        }
+        while (range.end > range.begin && bits[range.end - 1] == 0)
+        {
+            --range.end;
+        }
+        range.begin = range.begin / 8 * 8;
+        range.end = std::min((range.end + 7) / 8 * 8, m_ctx.num_words());
+        return range;
+    }
+
+    template <typename Criterion>
+    Node id3(size_t depth, Range range, std::bitset<64> used_attributes, int parent_mode)
+    {
+        tally(&BuildStats::nodes);
+
+        const int num_samples = class_counts(node_bits(depth), range);
+        if (num_samples == 0)
+        {
+            auto leaf = Node::make_leaf(parent_mode);
+            leaf.set_stats({0, 0, parent_mode});
+            return leaf;
+        }
+
+        NodeStats stats{.num_samples = num_samples};
+        for (size_t label = 0; label < m_ctx.num_classes(); ++label)
+        {
+            if (m_counts[label] > stats.mode_count)
+            {
+                stats.mode_count = m_counts[label];
+                stats.mode_label = static_cast<int>(label);
+            }
+        }
+        const int mode_label = stats.mode_label;
+        const auto with_stats = [&stats](Node node)
+        {
+            node.set_stats(stats);
+            return node;
+        };
+
+        if (stats.mode_count == stats.num_samples || used_attributes.count() == m_ctx.num_attributes() || stats.num_samples <= m_options.min_samples_split ||
+            static_cast<int>(depth) >= m_options.max_depth)
+        {
+            return with_stats(Node::make_leaf(mode_label));
+        }
+
+        float parent_impurity = 0;
+        if constexpr (Criterion::uses_parent_impurity)
+        {
+            parent_impurity = Criterion::impurity(num_samples, std::span<const int>(m_counts.data(), m_ctx.num_classes()));
+        }
+
+        float best_split_entropy = std::numeric_limits<float>::max();
+        int best_split_attribute = -1;
+        for (size_t col = 0; col < m_ctx.num_attributes(); ++col)
+        {
+            if (used_attributes.test(col))
+                continue;
+
+            tally(&BuildStats::evaluations);
+            if (value_totals(depth, range, col) <= 1)
+            {
+                tally(&BuildStats::constant_skips);
+                continue;
+            }
+
+            const auto entropy = split_score<Criterion>(depth, range, col, num_samples, parent_impurity, best_split_entropy);
+            if (std::isinf(entropy))
+            {
+                tally(&BuildStats::early_exits);
+            }
+            else if (entropy < best_split_entropy)
+            {
+                best_split_entropy = entropy;
+                best_split_attribute = static_cast<int>(col);
+            }
+        }
+
+        if (best_split_attribute < 0)
+        {
+            return with_stats(Node::make_leaf(mode_label));
+        }
+
+        const auto attr = static_cast<size_t>(best_split_attribute);
+        used_attributes.set(attr);
+
+        std::vector<Node> children;
+        uint64_t *child_bits = m_nodes.data() + (depth + 1) * m_ctx.num_words();
+        for (int value = 0; value < m_ctx.num_values(attr); ++value)
+        {
+            const auto n = range.end - range.begin;
+            if (and_popcount(m_ctx.kernel(), node_bits(depth) + range.begin, m_ctx.value_bits(attr, value) + range.begin, n, child_bits + range.begin) == 0)
+                continue;
+
+            // Words outside the parent's range are stale from earlier siblings' subtrees, but the child's range lies
+            // within its parent's, so they are never read.
+            auto child = id3<Criterion>(depth + 1, trim(child_bits, range), used_attributes, mode_label);
+            child.set_inter_label(value);
+            children.push_back(std::move(child));
+        }
+
+        return with_stats(Node::make_inter(best_split_attribute, std::move(children)));
+    }
+};
+
+template <typename Criterion = Entropy>
+inline Node build_tree(const BitmapContext &ctx, const BuildOptions &options)
+{
+    if (ctx.num_attributes() > 64)
+    {
+        throw std::invalid_argument("at most 64 attributes are supported");
+    }
+    return BitmapBuilder(ctx, options).build<Criterion>();
+}
+
+template <typename Criterion = Entropy>
+inline Node build_tree(const BitmapContext &ctx, int min_samples_split = 2)
+{
+    return build_tree<Criterion>(ctx, BuildOptions{.min_samples_split = min_samples_split});
+}
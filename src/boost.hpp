@@ -0,0 +1,192 @@
+#pragma once
+
+#include "dataset.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// A weighted vote of trees: each tree adds its weight to the class it predicts and the class with the most votes wins,
+// the smallest label on ties.
+class BoostedEnsemble
+{
+    std::vector<Node> m_trees;
+    std::vector<float> m_alphas;
+    size_t m_num_classes = 0;
+
+  public:
+    BoostedEnsemble() = default;
+
+    explicit BoostedEnsemble(size_t num_classes) : m_num_classes(num_classes) {}
+
+    void add(Node tree, float alpha)
+    {
+        m_trees.push_back(std::move(tree));
+        m_alphas.push_back(alpha);
+    }
+
+    size_t size() const { return m_trees.size(); }
+
+    size_t num_classes() const { return m_num_classes; }
+
+    const std::vector<Node> &trees() const { return m_trees; }
+
+    const std::vector<float> &alphas() const { return m_alphas; }
+
+    int predict(std::span<const int> obs) const
+    {
+        std::vector<float> votes(m_num_classes);
+        for (size_t t = 0; t < m_trees.size(); ++t)
+        {
+            const auto label = tree_predict(obs, m_trees[t]);
+            if (label >= 0 && static_cast<size_t>(label) < m_num_classes)
+            {
+                votes[label] += m_alphas[t];
+            }
+        }
+        return static_cast<int>(std::ranges::max_element(votes) - votes.begin());
+    }
+
+    // Predicts every `width`-value row of the row-major `observations` into `out`. Rows go through one tree at a time in
+    // blocks, so each tree stays in cache for the whole block, and the votes are tallied class by class over the block's
+    // labels with a branch-free loop the compiler vectorises.
+    void predict_batch(std::span<const int> observations, size_t width, std::span<int> out) const
+    {
+        if (observations.size() != out.size() * width)
+        {
+            throw std::invalid_argument("observations do not hold one row per output");
+        }
+
+        constexpr size_t block = 256;
+        std::array<int, block> labels;
+        std::vector<float> votes(m_num_classes * block);
+        for (size_t begin = 0; begin < out.size(); begin += block)
+        {
+            const size_t n = std::min(block, out.size() - begin);
+            std::ranges::fill(votes, 0.0f);
+            for (size_t t = 0; t < m_trees.size(); ++t)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    labels[i] = tree_predict(observations.subspan((begin + i) * width, width), m_trees[t]);
+                }
+
+                const float alpha = m_alphas[t];
+                for (size_t c = 0; c < m_num_classes; ++c)
+                {
+                    float *class_votes = votes.data() + c * block;
+                    const int label = static_cast<int>(c);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        class_votes[i] += labels[i] == label ? alpha : 0.0f;
+                    }
+                }
+            }
+
+            std::fill_n(labels.begin(), n, 0);
+            for (size_t c = 1; c < m_num_classes; ++c)
+            {
+                const float *class_votes = votes.data() + c * block;
+                const int label = static_cast<int>(c);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const bool better = class_votes[i] > votes[static_cast<size_t>(labels[i]) * block + i];
+                    labels[i] = better ? label : labels[i];
+                }
+            }
+            std::copy_n(labels.begin(), n, out.begin() + static_cast<std::ptrdiff_t>(begin));
+        }
+    }
+};
+
+struct BoostOptions
+{
+    int rounds = 50;
+    // Depth of each tree; one makes decision stumps.
+    int max_depth = 1;
+    // In rows of the original data, whatever weight they have been given since.
+    int min_samples_split = 2;
+};
+
+// SAMME, the multi-class AdaBoost: every round fits a shallow tree to the current row weights, gives it a say of
+// log((1 - err) / err) + log(K - 1) and multiplies the weights of the rows it got wrong by the exponential of that.
+// Stops early once a tree is no better than chance, or is perfect, in which case it is added and decides alone.
+//
+// All rounds train on one context whose weights are updated in place. The counting kernels add up integer weights, so
+// the real-valued boosting weights are scaled to a 2^30 total and rounded; rows whose weight falls below 2^-30 of
+// the total drop out of that round.
+template <typename Criterion = Entropy>
+inline BoostedEnsemble boost_trees(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, const BoostOptions &options = {})
+{
+    const size_t n = row_data.size();
+    if (n == 0)
+    {
+        return {};
+    }
+
+    const size_t num_classes = static_cast<size_t>(std::ranges::max(target_data)) + 1;
+    BoostedEnsemble ensemble(num_classes);
+    TrainingContext ctx(row_data, target_data);
+
+    constexpr double total_weight = 1 << 30;
+    const double scale = total_weight / static_cast<double>(n);
+    const BuildOptions build_options{
+        .min_samples_split = static_cast<int>(std::min(options.min_samples_split * scale, total_weight)),
+        .max_depth = options.max_depth,
+    };
+    const double chance_error = 1.0 - 1.0 / static_cast<double>(num_classes);
+    const double class_term = std::log(static_cast<double>(std::max<size_t>(num_classes, 2) - 1));
+
+    std::vector<double> weights(n, 1.0 / static_cast<double>(n));
+    std::vector<int> quantized(n);
+    std::vector<uint8_t> wrong(n);
+    for (int round = 0; round < options.rounds; ++round)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            quantized[i] = static_cast<int>(std::lround(weights[i] * total_weight));
+        }
+        ctx.set_weights(quantized);
+        auto tree = build_tree<Criterion>(ctx, build_options);
+
+        double error = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            wrong[i] = tree_predict(row_data[i], tree) != target_data[i];
+            error += wrong[i] ? weights[i] : 0.0;
+        }
+
+        if (error >= chance_error)
+        {
+            break;
+        }
+        if (error <= 0)
+        {
+            ensemble.add(std::move(tree), ensemble.size() == 0 ? 1.0f : static_cast<float>(std::log(1e10) + class_term));
+            break;
+        }
+
+        const double alpha = std::log((1 - error) / error) + class_term;
+        ensemble.add(std::move(tree), static_cast<float>(alpha));
+
+        const double boost = std::exp(alpha);
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            weights[i] *= wrong[i] ? boost : 1.0;
+            sum += weights[i];
+        }
+        for (auto &w : weights)
+        {
+            w /= sum;
+        }
+    }
+
+    return ensemble;
+}
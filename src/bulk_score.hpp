@@ -0,0 +1,263 @@
+#pragma once
+
+#include "node.hpp"
+#include "thread_pool.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <future>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// A whole file mapped read-only.
+class MappedFile
+{
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+
+  public:
+    explicit MappedFile(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st{};
+        if (fd < 0 || ::fstat(fd, &st) != 0)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            throw std::runtime_error("cannot open " + path);
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0)
+        {
+            void *p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            m_data = static_cast<const char *>(p);
+            ::madvise(p, m_size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        if (m_data)
+        {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+    }
+
+    std::string_view view() const { return {m_data, m_size}; }
+};
+
+enum class InputFormat
+{
+    // One observation per line, comma separated integers. Columns past the model's input width are ignored.
+    Csv,
+    // Raw host-order i32 values, row after row, exactly `width` values per row.
+    Binary,
+};
+
+struct BulkScoreOptions
+{
+    InputFormat format = InputFormat::Csv;
+    // Values per observation; binary input must say, csv defaults to the model's input width.
+    size_t width = 0;
+    // Csv only.
+    bool skip_header = false;
+    size_t chunk_bytes = size_t{1} << 22;
+    // Chunks parsed or scored ahead of the one being written; bounds memory to about window * chunk_bytes.
+    size_t window = 0;
+};
+
+// Cuts `data` into pieces of roughly `chunk_bytes`, each ending after a newline (or at the end of the data).
+inline std::vector<std::string_view> split_lines(std::string_view data, size_t chunk_bytes)
+{
+    std::vector<std::string_view> chunks;
+    while (!data.empty())
+    {
+        size_t end = std::min(data.size(), std::max<size_t>(chunk_bytes, 1));
+        if (end < data.size())
+        {
+            const auto nl = data.find('\n', end - 1);
+            end = nl == std::string_view::npos ? data.size() : nl + 1;
+        }
+        chunks.push_back(data.substr(0, end));
+        data.remove_prefix(end);
+    }
+    return chunks;
+}
+
+// Appends the first `width` values of every non-empty line in `chunk` to `values`, row-major.
+inline void parse_csv_rows(std::string_view chunk, size_t width, std::vector<int> &values)
+{
+    const char *p = chunk.data();
+    const char *const end = chunk.data() + chunk.size();
+    while (p < end)
+    {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol)
+            eol = end;
+        const char *line_end = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+
+        if (line_end > p)
+        {
+            for (size_t col = 0; col < width; ++col)
+            {
+                if (p > line_end)
+                {
+                    throw std::runtime_error("csv line has fewer than " + std::to_string(width) + " values");
+                }
+                int value = 0;
+                const auto [next, ec] = std::from_chars(p, line_end, value);
+                if (ec != std::errc() || (next != line_end && *next != ','))
+                {
+                    throw std::runtime_error("malformed csv line: " + std::string(p, line_end));
+                }
+                values.push_back(value);
+                p = next + 1;
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+inline std::string format_labels(std::span<const int> values, size_t width, const Node &tree)
+{
+    std::string out;
+    out.reserve(values.size() / width * 4);
+    char buf[16];
+    for (size_t i = 0; i + width <= values.size(); i += width)
+    {
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), tree_predict(values.subspan(i, width), tree));
+        out.append(buf, end);
+        out.push_back('\n');
+    }
+    return out;
+}
+
+// Scores every observation in `input` with `tree` and writes one label per line to `out`, in input order. Chunks are
+// parsed and scored on `pool` while the finished ones ahead of them are written out.
+inline size_t bulk_score(std::string_view input, const Node &tree, std::ostream &out, ThreadPool &pool, BulkScoreOptions options = {})
+{
+    if (options.format == InputFormat::Binary && options.width == 0)
+    {
+        throw std::invalid_argument("binary input needs a row width");
+    }
+    // A single-leaf model reads nothing, but every row still needs a value to be told apart.
+    const size_t width = std::max<size_t>(options.width ? options.width : tree_input_width(tree), 1);
+    if (width < tree_input_width(tree))
+    {
+        throw std::invalid_argument("rows are narrower than the model's input width");
+    }
+
+    if (options.format == InputFormat::Csv && options.skip_header)
+    {
+        const auto nl = input.find('\n');
+        input.remove_prefix(nl == std::string_view::npos ? input.size() : nl + 1);
+    }
+
+    std::vector<std::string_view> chunks;
+    if (options.format == InputFormat::Csv)
+    {
+        chunks = split_lines(input, options.chunk_bytes);
+    }
+    else
+    {
+        const size_t row_bytes = width * sizeof(int);
+        if (input.size() % row_bytes != 0)
+        {
+            throw std::runtime_error("binary input is not a whole number of rows");
+        }
+        const size_t chunk = std::max<size_t>(options.chunk_bytes / row_bytes, 1) * row_bytes;
+        for (size_t off = 0; off < input.size(); off += chunk)
+        {
+            chunks.push_back(input.substr(off, chunk));
+        }
+    }
+
+    const size_t window = options.window ? options.window : 2 * pool.size();
+    std::deque<std::future<std::string>> in_flight;
+    size_t lines = 0;
+
+    const auto write_front = [&]
+    {
+        const auto text = in_flight.front().get();
+        in_flight.pop_front();
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        lines += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    };
+
+    try
+    {
+        for (const auto chunk : chunks)
+        {
+            if (in_flight.size() >= window)
+            {
+                write_front();
+            }
+
+            auto done = std::make_shared<std::promise<std::string>>();
+            in_flight.push_back(done->get_future());
+            pool.submit(
+                [chunk, width, &tree, format = options.format, done]
+                {
+                    try
+                    {
+                        if (format == InputFormat::Binary)
+                        {
+                            // The mapping is page aligned and rows are whole ints, so the values can be read in place.
+                            const std::span<const int> values(reinterpret_cast<const int *>(chunk.data()), chunk.size() / sizeof(int));
+                            done->set_value(format_labels(values, width, tree));
+                        }
+                        else
+                        {
+                            std::vector<int> values;
+                            values.reserve(chunk.size() / 2);
+                            parse_csv_rows(chunk, width, values);
+                            done->set_value(format_labels(values, width, tree));
+                        }
+                    }
+                    catch (...)
+                    {
+                        done->set_exception(std::current_exception());
+                    }
+                });
+        }
+
+        while (!in_flight.empty())
+        {
+            write_front();
+        }
+    }
+    catch (...)
+    {
+        // Chunks still in the pool read from `input` and `tree`, which the caller may release once we return.
+        for (auto &f : in_flight)
+        {
+            if (f.valid())
+                f.wait();
+        }
+        throw;
+    }
+    out.flush();
+    return lines;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Stable counting sorts of a window of row indices by a categorical column, the kernel behind Dataset::sort_by. Both
+// take a zeroed count buffer and leave it zeroed, and sort `idxs` in place through `output`.
+
+// One histogram, then a reverse scatter through it. With few distinct keys every row increments one of the same few
+// counters, so consecutive rows wait on each other's store.
+inline void counting_sort_scalar(const int *col_data, int *idxs, size_t n, int *count, int *output)
+{
+    int max_val = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        int key = col_data[idxs[i]];
+        ++count[key];
+        max_val = std::max(max_val, key);
+    }
+
+    for (int i = 1; i <= max_val; i++)
+    {
+        count[i] += count[i - 1];
+    }
+
+    for (size_t i = n; i-- > 0;)
+    {
+        int idx = idxs[i];
+        int key = col_data[idx];
+        output[--count[key]] = idx;
+    }
+
+    std::memcpy(idxs, output, n * sizeof(int));
+    std::memset(count, 0, (static_cast<size_t>(max_val) + 1) * sizeof(int));
+}
+
+inline constexpr size_t counting_sort_lanes = 4;
+// Past this many keys the runs' scatter streams outnumber what the caches hold well, and below this many rows the setup
+// does not pay off; the interleaved sort hands both cases to the scalar one.
+inline constexpr int counting_sort_max_interleaved_keys = 32;
+inline constexpr size_t counting_sort_min_interleaved_rows = 64;
+
+namespace counting_sort_kernels
+{
+// Loads the key of every row into `keys` and returns the largest.
+inline int gather_keys_scalar(const int *col_data, const int *idxs, int *keys, size_t n)
+{
+    int max_key = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = col_data[idxs[i]];
+        max_key = std::max(max_key, keys[i]);
+    }
+    return max_key;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) inline int gather_keys_avx2(const int *col_data, const int *idxs, int *keys, size_t n)
+{
+    __m256i max_keys = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256i rows = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idxs + i));
+        const __m256i k = _mm256_i32gather_epi32(col_data, rows, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(keys + i), k);
+        max_keys = _mm256_max_epi32(max_keys, k);
+    }
+
+    alignas(32) std::array<int, 8> lanes;
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes.data()), max_keys);
+    return std::max(std::ranges::max(lanes), gather_keys_scalar(col_data, idxs + i, keys + i, n - i));
+}
+#endif
+
+inline int gather_keys(const int *col_data, const int *idxs, int *keys, size_t n)
+{
+#if defined(__x86_64__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2)
+        return gather_keys_avx2(col_data, idxs, keys, n);
+#endif
+    return gather_keys_scalar(col_data, idxs, keys, n);
+}
+} // namespace counting_sort_kernels
+
+// Splits the window into counting_sort_lanes contiguous runs with a histogram each and works through the runs in
+// lockstep, so neighbouring increments and scatter writes go to different counters. Counts are prefix-summed key by
+// key and run by run within a key, which keeps the sort stable while every run scatters forwards. The keys are gathered
+// once, with AVX2 where the CPU has it, into `keys`. `count` needs room for counting_sort_lanes * (largest key + 1).
+inline void counting_sort_interleaved(const int *col_data, int *idxs, size_t n, int *count, int *keys, int *output)
+{
+    constexpr size_t lanes = counting_sort_lanes;
+    if (n < counting_sort_min_interleaved_rows)
+    {
+        counting_sort_scalar(col_data, idxs, n, count, output);
+        return;
+    }
+
+    const int max_key = counting_sort_kernels::gather_keys(col_data, idxs, keys, n);
+    if (max_key >= counting_sort_max_interleaved_keys)
+    {
+        counting_sort_scalar(col_data, idxs, n, count, output);
+        return;
+    }
+    const size_t stride = static_cast<size_t>(max_key) + 1;
+
+    // Runs shrink towards the end, so the last one is the length all runs share.
+    const size_t run = (n + lanes - 1) / lanes;
+    std::array<size_t, lanes + 1> begin;
+    for (size_t lane = 0; lane <= lanes; ++lane)
+    {
+        begin[lane] = std::min(lane * run, n);
+    }
+    const size_t common = begin[lanes] - begin[lanes - 1];
+
+    for (size_t i = 0; i < common; ++i)
+    {
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            ++count[lane * stride + static_cast<size_t>(keys[begin[lane] + i])];
+        }
+    }
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        for (size_t i = begin[lane] + common; i < begin[lane + 1]; ++i)
+        {
+            ++count[lane * stride + static_cast<size_t>(keys[i])];
+        }
+    }
+
+    int offset = 0;
+    for (size_t key = 0; key < stride; ++key)
+    {
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            const int c = count[lane * stride + key];
+            count[lane * stride + key] = offset;
+            offset += c;
+        }
+    }
+
+    for (size_t i = 0; i < common; ++i)
+    {
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            const size_t pos = begin[lane] + i;
+            output[count[lane * stride + static_cast<size_t>(keys[pos])]++] = idxs[pos];
+        }
+    }
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        for (size_t pos = begin[lane] + common; pos < begin[lane + 1]; ++pos)
+        {
+            output[count[lane * stride + static_cast<size_t>(keys[pos])]++] = idxs[pos];
+        }
+    }
+
+    std::memcpy(idxs, output, n * sizeof(int));
+    std::memset(count, 0, lanes * stride * sizeof(int));
+}
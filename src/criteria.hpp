@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+
+// Split criteria are compile-time policies for id3. A split is scored partition by partition: `impurity` returns the
+// impurity of one partition scaled by its row count, and `score` turns the summed partitions into the value id3
+// minimises. Criteria that need the split information or the parent's impurity opt in through the flags so the others
+// pay nothing for them. `score_range` bounds the score divided by the row count, which is what sampled split selection
+// needs to tell how far an estimate from a sample can be off; criteria without such a bound return infinity.
+// `exits_early` says the score is the plain sum of the partition impurities, so a split whose first partitions already
+// add up to the best score so far can be abandoned.
+
+struct Entropy
+{
+    static constexpr bool uses_split_info = false;
+    static constexpr bool uses_parent_impurity = false;
+    static constexpr bool exits_early = true;
+
+    static float impurity(int total, std::span<const int> counts)
+    {
+        float entropy = 0;
+        for (auto cnt : counts)
+        {
+            if (cnt == 0)
+                continue;
+            const float prop = static_cast<float>(cnt) / static_cast<float>(total);
+            entropy = static_cast<float>(entropy - prop * std::log(static_cast<double>(prop)));
+        }
+        return entropy * static_cast<float>(total);
+    }
+
+    static float score(float split_impurity, float /*parent_impurity*/, float /*split_info*/) { return split_impurity; }
+
+    static double score_range(size_t num_classes) { return std::log(static_cast<double>(std::max<size_t>(num_classes, 2))); }
+};
+
+struct Gini
+{
+    static constexpr bool uses_split_info = false;
+    static constexpr bool uses_parent_impurity = false;
+    static constexpr bool exits_early = true;
+
+    static float impurity(int total, std::span<const int> counts)
+    {
+        float sum_sq = 0;
+        for (auto cnt : counts)
+        {
+            const auto c = static_cast<float>(cnt);
+            sum_sq += c * c;
+        }
+        return static_cast<float>(total) - sum_sq / static_cast<float>(total);
+    }
+
+    static float score(float split_impurity, float /*parent_impurity*/, float /*split_info*/) { return split_impurity; }
+
+    static double score_range(size_t /*num_classes*/) { return 1; }
+};
+
+// C4.5 gain ratio: information gain normalised by the entropy of the partition sizes, which stops attributes with many
+// values from winning just by shattering the node. Single-valued splits carry no information and are never chosen.
+struct GainRatio
+{
+    static constexpr bool uses_split_info = true;
+    static constexpr bool uses_parent_impurity = true;
+    static constexpr bool exits_early = false;
+
+    static float impurity(int total, std::span<const int> counts) { return Entropy::impurity(total, counts); }
+
+    // The partition's term of the split information, scaled by the node's row count like the impurities are.
+    static float split_info(int partition_total, int node_total)
+    {
+        const float prop = static_cast<float>(partition_total) / static_cast<float>(node_total);
+        return -prop * std::log(prop) * static_cast<float>(node_total);
+    }
+
+    static float score(float split_impurity, float parent_impurity, float split_info)
+    {
+        if (split_info <= 0)
+            return std::numeric_limits<float>::max();
+
+        return -(parent_impurity - split_impurity) / split_info;
+    }
+
+    static double score_range(size_t /*num_classes*/) { return std::numeric_limits<double>::infinity(); }
+};
@@ -1,155 +1,591 @@
 #pragma once
 
+#include "counting_sort.hpp"
+#include "node.hpp"
+
 #include <algorithm>
+#include <bitset>
+#include <cstring>
 #include <fmt/core.h>
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <numeric>
+#include <span>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
 
-struct InnerDataset
+class Dataset;
+
+// One column of values in caller memory, `stride` values apart: 1 for a column stored on its own, the row width for a
+// column of a row-major array.
+struct StridedColumn
+{
+    const int *data = nullptr;
+    size_t stride = 1;
+
+    int operator[](size_t row) const { return data[row * stride]; }
+};
+
+// Owns everything a build needs: the columnar copy of the data (unless it uses columns in place, see assign_view), the
+// row index buffer that id3 partitions in place and the scratch buffers used while scoring. Buffers are only ever grown,
+// so rebuilding on same-sized (or smaller) data allocates nothing.
+//
+// Every row carries an integer weight, one unless assigned otherwise; all counting during a build adds up weights, so a
+// row of weight k trains exactly like k copies of it.
+//
+// Columns flagged as numeric are split on thresholds instead of per value. Each numeric column gets the selected rows
+// presorted by value once per selection; every build starts from a copy of that order and keeps it partitioned
+// alongside the index buffer, so each node sees its rows already sorted by every numeric column.
+class TrainingContext
 {
-    std::vector<std::vector<int>> m_row_data;
+    friend class Dataset;
+
     std::vector<std::vector<int>> m_col_data;
     std::vector<int> m_target_data;
+    // What builds read: the two above, or columns used in place (assign_view), kept alive by m_view_owner.
+    std::vector<std::span<const int>> m_cols;
+    std::span<const int> m_target;
+    std::shared_ptr<const void> m_view_owner;
+    std::vector<int> m_weights;
+    std::bitset<64> m_numeric;
     std::vector<int> m_count_scratch_buf;
+    std::vector<int> m_left_counts;
+    std::vector<int> m_right_counts;
+    std::vector<int> m_joint_counts;
+    std::vector<int> m_sample_buf;
+    std::vector<int> m_sort_counts;
+    std::vector<int> m_idx_buf;
+    std::vector<int> m_sort_buf;
+    std::vector<int> m_sort_keys;
+    std::vector<int> m_best_buf;
+    std::vector<std::vector<int>> m_num_sorted;
+    std::vector<std::vector<int>> m_num_order;
+    size_t m_num_rows = 0;
+    // Reused for every small node whose subtree is built on a compact copy of its rows; see Dataset::localize.
+    std::unique_ptr<TrainingContext> m_local;
+    bool m_is_local = false;
+
+  public:
+    TrainingContext() = default;
+
+    TrainingContext(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target, std::bitset<64> numeric = {})
+    {
+        assign(row_data, target, numeric);
+    }
+
+    TrainingContext(const TrainingContext &) = delete;
+    TrainingContext &operator=(const TrainingContext &) = delete;
+    TrainingContext(TrainingContext &&) = default;
+    TrainingContext &operator=(TrainingContext &&) = default;
 
-    InnerDataset(std::vector<std::vector<int>> row_data, std::vector<int> target) : m_row_data(std::move(row_data)), m_target_data(std::move(target))
+    void assign(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target, std::bitset<64> numeric = {})
     {
-        m_col_data.resize(m_row_data[0].size(), std::vector<int>(m_row_data.size()));
+        m_num_rows = row_data.size();
+        const size_t ncols = row_data.empty() ? 0 : row_data[0].size();
+
+        m_numeric = numeric;
+        m_col_data.resize(ncols);
+        for (auto &col : m_col_data)
+        {
+            col.resize(m_num_rows);
+        }
+        m_target_data.assign(target.begin(), target.end());
+        m_weights.assign(m_num_rows, 1);
 
-        int mx = 0;
+        int max_target = 0;
         for (auto t : m_target_data)
         {
-            mx = std::max(mx, t);
+            max_target = std::max(max_target, t);
         }
-        for (const auto &r : m_row_data)
+
+        // Numeric values never index a count buffer, so only categorical columns size it.
+        int mx = max_target;
+        for (size_t i = 0; i < m_num_rows; ++i)
         {
-            for (auto v : r)
+            const auto &r = row_data[i];
+            for (size_t j = 0; j < ncols; ++j)
             {
-                mx = std::max(mx, v);
+                m_col_data[j][i] = r[j];
+                if (!m_numeric.test(j))
+                {
+                    mx = std::max(mx, r[j]);
+                }
             }
         }
-        m_count_scratch_buf.resize(mx + 1, 0);
-        for (size_t i = 0; i < m_row_data.size(); ++i)
+
+        size_count_bufs(mx, max_target);
+        use_own_data();
+        select_all();
+    }
+
+    // Trains on `cols` and `target` where they are instead of copying them, e.g. a table mapped from shared memory.
+    // `owner` is held until the context is reassigned, to keep them alive. No categorical value may exceed
+    // `max_value` and no label `max_target`; they size the count buffers.
+    void assign_view(std::vector<std::span<const int>> cols, std::span<const int> target, int max_value, int max_target, std::bitset<64> numeric = {},
+                     std::shared_ptr<const void> owner = {})
+    {
+        for (const auto col : cols)
         {
-            for (size_t j = 0; j < m_row_data[0].size(); ++j)
+            if (col.size() != target.size())
             {
-                m_col_data[j][i] = m_row_data[i][j];
+                throw std::invalid_argument("every column needs one value per row");
             }
         }
+
+        m_num_rows = target.size();
+        m_numeric = numeric;
+        m_cols = std::move(cols);
+        m_target = target;
+        m_view_owner = std::move(owner);
+        m_weights.assign(m_num_rows, 1);
+        size_count_bufs(std::max(max_value, max_target), max_target);
+        select_all();
     }
-};
 
-class Dataset
-{
-    InnerDataset *m_inner;
-    std::vector<int> m_sorted_idxs;
+    // Trains on `num_rows` rows held column by column in caller memory, which must stay valid until the context is
+    // reassigned. Contiguous columns are used in place; strided ones are gathered into the context's own buffers, all
+    // in one pass over the rows, since they are usually the columns of one row-major array.
+    void assign_columns(std::span<const StridedColumn> cols, StridedColumn target, size_t num_rows, std::bitset<64> numeric = {})
+    {
+        m_col_data.resize(cols.size());
+        std::vector<std::span<const int>> views(cols.size());
+        std::vector<StridedColumn> gather_from;
+        std::vector<int *> gather_to;
+        const auto view = [&](StridedColumn col, std::vector<int> &buf) -> std::span<const int>
+        {
+            if (col.stride == 1)
+                return {col.data, num_rows};
+
+            buf.resize(num_rows);
+            gather_from.push_back(col);
+            gather_to.push_back(buf.data());
+            return buf;
+        };
+        for (size_t col = 0; col < cols.size(); ++col)
+        {
+            views[col] = view(cols[col], m_col_data[col]);
+        }
+        const auto target_view = view(target, m_target_data);
+        for (size_t i = 0; i < num_rows; ++i)
+        {
+            for (size_t k = 0; k < gather_from.size(); ++k)
+            {
+                gather_to[k][i] = gather_from[k][i];
+            }
+        }
 
-  public:
-    explicit Dataset(InnerDataset *inner) : m_inner(std::move(inner)), m_sorted_idxs(m_inner->m_row_data.size())
+        int max_value = 0;
+        for (size_t col = 0; col < cols.size(); ++col)
+        {
+            if (!numeric.test(col) && num_rows > 0)
+            {
+                max_value = std::max(max_value, std::ranges::max(views[col]));
+            }
+        }
+        const int max_target = num_rows > 0 ? std::max(0, std::ranges::max(target_view)) : 0;
+        assign_view(std::move(views), target_view, max_value, max_target, numeric);
+    }
+
+    // Like assign, with row i counting `weights[i]` times.
+    void assign_weighted(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target, std::span<const int> weights,
+                         std::bitset<64> numeric = {})
     {
-        std::iota(m_sorted_idxs.begin(), m_sorted_idxs.end(), 0);
+        if (weights.size() != row_data.size())
+        {
+            throw std::invalid_argument("one weight per row is needed");
+        }
+        assign(row_data, target, numeric);
+        std::ranges::copy(weights, m_weights.begin());
     }
 
-    Dataset(InnerDataset *inner, size_t nrows) : m_inner(inner), m_sorted_idxs(nrows) {}
+    // Assigns `rows` of `source`, in that order, as this context's rows; columns in `skip` are left empty. Keeps the
+    // source's count buffer sizes, so the class and value ranges are the same.
+    void assign_rows(const TrainingContext &source, std::span<const int> rows, std::bitset<64> skip = {})
+    {
+        m_num_rows = rows.size();
+        m_numeric = source.m_numeric;
+        m_col_data.resize(source.m_cols.size());
+        const auto gather = [&rows](std::vector<int> &dst, std::span<const int> src)
+        {
+            dst.resize(rows.size());
+            for (size_t i = 0; i < rows.size(); ++i)
+            {
+                dst[i] = src[static_cast<size_t>(rows[i])];
+            }
+        };
+        for (size_t col = 0; col < m_col_data.size(); ++col)
+        {
+            if (skip.test(col))
+            {
+                m_col_data[col].clear();
+                continue;
+            }
+            gather(m_col_data[col], source.m_cols[col]);
+        }
+        gather(m_target_data, source.m_target);
+        gather(m_weights, source.m_weights);
+        use_own_data();
+
+        // Scratch buffers are always left zeroed, so growing them is all they need.
+        m_count_scratch_buf.resize(source.m_count_scratch_buf.size());
+        m_left_counts.resize(source.m_left_counts.size());
+        m_right_counts.resize(source.m_right_counts.size());
+        m_joint_counts.resize(source.m_joint_counts.size());
+        m_sort_counts.resize(source.m_sort_counts.size());
+        select_all();
+    }
 
-    Dataset() = default;
+    // Replaces the label column, keeping the rows, their weights and the current selection.
+    void set_target(std::span<const int> target)
+    {
+        if (target.size() != m_num_rows)
+        {
+            throw std::invalid_argument("one label per row is needed");
+        }
+        m_target_data.assign(target.begin(), target.end());
+        m_target = m_target_data;
+
+        const size_t num_classes = target.empty() ? 1 : static_cast<size_t>(std::ranges::max(target)) + 1;
+        m_left_counts.assign(num_classes, 0);
+        m_right_counts.assign(num_classes, 0);
+        m_count_scratch_buf.resize(std::max(m_count_scratch_buf.size(), num_classes));
+        m_joint_counts.assign(m_count_scratch_buf.size() * num_classes, 0);
+        m_sort_counts.resize(counting_sort_lanes * m_count_scratch_buf.size());
+    }
 
-    void sort_by(size_t col)
+    // Reweights the assigned rows in place, e.g. between boosting rounds.
+    void set_weights(std::span<const int> weights)
     {
-        const auto &col_data = m_inner->m_col_data[col];
-        size_t n = m_sorted_idxs.size();
-        auto &count = m_inner->m_count_scratch_buf;
+        if (weights.size() != m_num_rows)
+        {
+            throw std::invalid_argument("one weight per row is needed");
+        }
+        std::ranges::copy(weights, m_weights.begin());
+    }
+
+    // Train on every row of the assigned data.
+    void select_all()
+    {
+        resize_idx_bufs(m_num_rows);
+        std::iota(m_idx_buf.begin(), m_idx_buf.end(), 0);
+        presort_numeric();
+    }
+
+    // Train on an arbitrary multiset of rows, e.g. a bootstrap sample or one fold of a cross validation.
+    void select(std::span<const int> rows)
+    {
+        resize_idx_bufs(rows.size());
+        std::ranges::copy(rows, m_idx_buf.begin());
+        presort_numeric();
+    }
+
+    size_t num_rows() const { return m_num_rows; }
+
+    size_t num_attributes() const { return m_cols.size(); }
+
+    bool has_numeric() const { return m_numeric.any(); }
+
+    int value(size_t col, int row) const { return m_cols[col][row]; }
+
+    int target(int row) const { return m_target[row]; }
+
+    int weight(int row) const { return m_weights[row]; }
+
+    // Resets the per-build state and returns the view over all selected rows.
+    Dataset begin_build();
+
+  private:
+    void resize_idx_bufs(size_t n)
+    {
+        m_idx_buf.resize(n);
+        m_sort_buf.resize(n);
+        m_sort_keys.resize(n);
+        m_best_buf.resize(n);
+    }
+
+    void size_count_bufs(int max_value, int max_target)
+    {
+        m_count_scratch_buf.assign(static_cast<size_t>(max_value) + 1, 0);
+        m_left_counts.assign(static_cast<size_t>(max_target) + 1, 0);
+        m_right_counts.assign(static_cast<size_t>(max_target) + 1, 0);
+        m_joint_counts.assign(m_count_scratch_buf.size() * m_left_counts.size(), 0);
+        m_sort_counts.assign(counting_sort_lanes * m_count_scratch_buf.size(), 0);
+    }
 
-        int max_val = 0;
-        for (int idx : m_sorted_idxs)
+    void use_own_data()
+    {
+        m_cols.assign(m_col_data.begin(), m_col_data.end());
+        m_target = m_target_data;
+        m_view_owner.reset();
+    }
+
+    void presort_numeric()
+    {
+        m_num_sorted.resize(m_cols.size());
+        m_num_order.resize(m_cols.size());
+        for (size_t col = 0; col < m_cols.size(); ++col)
         {
-            int key = col_data[idx];
-            ++count[key];
-            max_val = std::max(max_val, key);
+            if (!m_numeric.test(col))
+                continue;
+
+            const auto col_data = m_cols[col];
+            auto &sorted = m_num_sorted[col];
+            sorted.assign(m_idx_buf.begin(), m_idx_buf.end());
+            std::ranges::stable_sort(sorted, std::less<>(), [&](int idx) { return col_data[idx]; });
+            m_num_order[col].resize(sorted.size());
         }
+    }
+};
 
-        for (size_t i = 1; i <= max_val; i++)
+struct WeightedRows
+{
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    std::vector<int> weights;
+};
+
+// Merges rows that agree on every attribute and on the label into one row weighted by how often it occurs, in the order
+// the rows first appear.
+inline WeightedRows collapse_duplicates(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target)
+{
+    const auto less = [&](int a, int b) { return std::tie(row_data[a], target[a]) < std::tie(row_data[b], target[b]); };
+    std::vector<int> order(row_data.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, less);
+
+    // (first occurrence, count) per distinct row
+    std::vector<std::pair<int, int>> groups;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (i > 0 && !less(order[i - 1], order[i]))
+        {
+            ++groups.back().second;
+        }
+        else
         {
-            count[i] += count[i - 1];
+            groups.emplace_back(order[i], 1);
         }
+    }
+    std::ranges::sort(groups);
+
+    WeightedRows unique;
+    for (const auto &[row, count] : groups)
+    {
+        unique.rows.push_back(row_data[row]);
+        unique.target.push_back(target[row]);
+        unique.weights.push_back(count);
+    }
+    return unique;
+}
+
+// A node's rows: a window of the context's index buffer. Copies are cheap and share the same storage, so
+// reordering one view reorders every view over the same window.
+class Dataset
+{
+    TrainingContext *m_ctx = nullptr;
+    int *m_sorted_idxs = nullptr;
+    size_t m_size = 0;
 
-        std::vector<int> output(n);
-        for (int i = n - 1; i >= 0; i--)
+  public:
+    Dataset(TrainingContext *ctx, int *idxs, size_t nrows) : m_ctx(ctx), m_sorted_idxs(idxs), m_size(nrows) {}
+
+    Dataset() = default;
+
+    void sort_by(size_t col) { counting_sort(m_sorted_idxs, col); }
+
+    // Lines every numeric column's presorted window up with the children of a split on categorical `col`, which must
+    // be the column the rows are currently sorted by.
+    void partition_numeric(size_t col)
+    {
+        for (size_t c = 0; c < num_attributes(); ++c)
         {
-            int idx = m_sorted_idxs[i];
-            int key = col_data[idx];
-            int pos = count[key] - 1;
-            output[pos] = idx;
-            count[key]--;
+            if (is_numeric(c))
+            {
+                counting_sort(numeric_order(c), col);
+            }
         }
+    }
 
-        m_sorted_idxs = std::move(output);
-        std::memset(count.data(), 0, count.size() * sizeof(int));
+    // Splits the rows on numeric `col` at `threshold`: rows <= threshold, in order of `col`, move to the front of the
+    // window and the rest follow, with every numeric column's window partitioned the same way.
+    void partition_threshold(size_t col, int threshold)
+    {
+        const auto &col_data = m_ctx->m_cols[col];
+        std::memcpy(m_sorted_idxs, numeric_order(col), m_size * sizeof(int));
+
+        for (size_t c = 0; c < num_attributes(); ++c)
+        {
+            if (c == col || !is_numeric(c))
+                continue;
+
+            int *order = numeric_order(c);
+            int *right = m_ctx->m_sort_buf.data();
+            size_t nleft = 0;
+            size_t nright = 0;
+            for (size_t i = 0; i < m_size; ++i)
+            {
+                const int idx = order[i];
+                if (col_data[idx] <= threshold)
+                {
+                    order[nleft++] = idx;
+                }
+                else
+                {
+                    right[nright++] = idx;
+                }
+            }
+            std::memcpy(order + nleft, right, nright * sizeof(int));
+        }
     }
 
-    std::vector<int> &count_scratch_buf() { return m_inner->m_count_scratch_buf; }
+    // Stash the current ordering so it can be brought back after sorting by other columns.
+    void save_order() const { std::memcpy(m_ctx->m_best_buf.data(), m_sorted_idxs, m_size * sizeof(int)); }
 
-    const std::vector<int> &get_row(int row) const { return m_inner->m_row_data[row]; }
+    void restore_order() { std::memcpy(m_sorted_idxs, m_ctx->m_best_buf.data(), m_size * sizeof(int)); }
 
-    int get_target(int row) const { return m_inner->m_target_data[row]; }
+    std::vector<int> &count_scratch_buf() { return m_ctx->m_count_scratch_buf; }
 
-    const std::vector<int> &get_row_sorted(int row) const { return m_inner->m_row_data[m_sorted_idxs[row]]; }
+    // Zeroed, class-sized buffers for the two sides of a threshold split.
+    std::span<int> left_counts() { return m_ctx->m_left_counts; }
 
-    int get_col_sorted(int col, int entry) const { return m_inner->m_col_data[col][m_sorted_idxs[entry]]; }
+    std::span<int> right_counts() { return m_ctx->m_right_counts; }
 
-    int get_target_sorted(int row) const { return m_inner->m_target_data[m_sorted_idxs[row]]; }
+    size_t num_classes() const { return m_ctx->m_left_counts.size(); }
 
-    size_t num_rows() const { return m_sorted_idxs.size(); }
+    // Zeroed value-by-class count table, num_classes() counts per categorical value.
+    std::span<int> joint_counts() { return m_ctx->m_joint_counts; }
 
-    size_t num_attributes() const { return m_inner->m_col_data.size(); }
+    // Scratch for rows drawn from the node when choosing a split on a sample.
+    std::vector<int> &sample_buf() { return m_ctx->m_sample_buf; }
 
-    const std::vector<int> &get_target_data() const { return m_inner->m_target_data; }
+    bool is_numeric(size_t col) const { return m_ctx->m_numeric.test(col); }
 
-    std::pair<int, int> mode_label() const
+    bool has_numeric() const { return m_ctx->has_numeric(); }
+
+    // Whether this view is over a copy made by localize.
+    bool is_local() const { return m_ctx->m_is_local; }
+
+    // The node's rows copied, in the node's order, into a compact context of their own, skipping the `used` columns.
+    // Scoring and partitioning the copy makes the same choices as on the node while only touching a few contiguous
+    // columns rather than gathering from whole ones. The copy is overwritten by the next call on the same context.
+    Dataset localize(std::bitset<64> used) const
+    {
+        auto &local = m_ctx->m_local;
+        if (!local)
+        {
+            local = std::make_unique<TrainingContext>();
+            local->m_is_local = true;
+        }
+        local->assign_rows(*m_ctx, std::span<const int>(m_sorted_idxs, m_size), used);
+        return local->begin_build();
+    }
+
+    // The node's rows sorted by numeric column `col`.
+    int *numeric_order(size_t col) const { return m_ctx->m_num_order[col].data() + offset(); }
+
+    int get_col(size_t col, int row) const { return m_ctx->m_cols[col][row]; }
+
+    int get_target(int row) const { return m_ctx->m_target[row]; }
+
+    int get_col_sorted(int col, size_t entry) const { return m_ctx->m_cols[col][m_sorted_idxs[entry]]; }
+
+    int get_target_sorted(size_t row) const { return m_ctx->m_target[m_sorted_idxs[row]]; }
+
+    int get_weight(int row) const { return m_ctx->m_weights[row]; }
+
+    int get_weight_sorted(size_t entry) const { return m_ctx->m_weights[m_sorted_idxs[entry]]; }
+
+    // The summed weight of the node's rows, which is its row count unless rows are weighted.
+    int total_weight() const
+    {
+        int total = 0;
+        for (size_t i = 0; i < m_size; ++i)
+        {
+            total += m_ctx->m_weights[m_sorted_idxs[i]];
+        }
+        return total;
+    }
+
+    // Whether every row of the node has the same value in `col`; found without sorting, and usually after a few rows
+    // when it does not.
+    bool is_constant(size_t col) const
     {
-        auto &counts = m_inner->m_count_scratch_buf;
+        const auto &col_data = m_ctx->m_cols[col];
+        const int first = col_data[m_sorted_idxs[0]];
+        for (size_t i = 1; i < m_size; ++i)
+        {
+            if (col_data[m_sorted_idxs[i]] != first)
+                return false;
+        }
+        return true;
+    }
+
+    // The context row at position `entry` of the node.
+    int row_index(size_t entry) const { return m_sorted_idxs[entry]; }
 
-        int highest_count = 0;
-        int ret = 0;
+    size_t num_rows() const { return m_size; }
 
-        for (auto idx : m_sorted_idxs)
+    size_t num_attributes() const { return m_ctx->m_cols.size(); }
+
+    std::span<const int> get_target_data() const { return m_ctx->m_target; }
+
+    // The node's weighted row count and its most common label, the smallest one on ties so that the answer does not
+    // depend on the order of the rows.
+    NodeStats node_stats() const
+    {
+        auto &counts = m_ctx->m_count_scratch_buf;
+        const auto &target = m_ctx->m_target;
+        const auto &weights = m_ctx->m_weights;
+
+        NodeStats stats;
+        for (size_t i = 0; i < m_size; ++i)
         {
-            const auto x = m_inner->m_target_data[idx];
+            const int idx = m_sorted_idxs[i];
+            counts[target[idx]] += weights[idx];
+            stats.num_samples += weights[idx];
+        }
 
-            ++counts[x];
-            if (counts[x] > highest_count)
+        for (size_t label = 0; label < num_classes(); ++label)
+        {
+            if (counts[label] > stats.mode_count)
             {
-                highest_count = counts[x];
-                ret = x;
+                stats.mode_count = counts[label];
+                stats.mode_label = static_cast<int>(label);
             }
         }
 
-        std::memset(counts.data(), 0, counts.size() * sizeof(int));
-
-        return {ret, highest_count};
+        std::memset(counts.data(), 0, num_classes() * sizeof(int));
+        return stats;
     }
 
-    Dataset copy_from(size_t start, size_t end) const
+    std::pair<int, int> mode_label() const
     {
-        const auto count = end - start;
+        const auto stats = node_stats();
+        return {stats.mode_label, stats.mode_count};
+    }
 
-        Dataset ret(m_inner, count);
-        std::memcpy(ret.m_sorted_idxs.data(), m_sorted_idxs.data() + start, count * sizeof(int));
+    Dataset slice(size_t start, size_t end) const { return Dataset(m_ctx, m_sorted_idxs + start, end - start); }
 
-        return ret;
+    size_t find_next_label(int col, int label, size_t from = 0) const
+    {
+        const auto &col_data = m_ctx->m_cols[col];
+        const auto *it = std::upper_bound(m_sorted_idxs + from, m_sorted_idxs + m_size, label, [&](int l, int idx) { return l < col_data[idx]; });
+        return static_cast<size_t>(it - m_sorted_idxs);
     }
 
-    size_t find_next_label(int col, int label) const
+  private:
+    size_t offset() const { return static_cast<size_t>(m_sorted_idxs - m_ctx->m_idx_buf.data()); }
+
+    // Stable counting sort of the node's window of `idxs` by categorical column `col`.
+    void counting_sort(int *idxs, size_t col)
     {
-        const auto &col_data = m_inner->m_col_data[col];
-        auto it = std::ranges::upper_bound(m_sorted_idxs, label, std::less<>(), [&](int idx) { return col_data[idx]; });
-        return std::distance(m_sorted_idxs.begin(), it);
+        counting_sort_interleaved(m_ctx->m_cols[col].data(), idxs, m_size, m_ctx->m_sort_counts.data(), m_ctx->m_sort_keys.data(),
+                                  m_ctx->m_sort_buf.data());
     }
 
-  private:
     class SplitDatasetIterator
     {
       public:
@@ -163,13 +599,13 @@ class Dataset
 
         Dataset operator*() const
         {
-            size_t next_idx = m_ds->find_next_label(m_attribute, m_ds->get_col_sorted(m_attribute, m_idx));
-            return m_ds->copy_from(m_idx, next_idx);
+            size_t next_idx = m_ds->find_next_label(m_attribute, m_ds->get_col_sorted(m_attribute, m_idx), m_idx);
+            return m_ds->slice(m_idx, next_idx);
         }
 
         SplitDatasetIterator &operator++()
         {
-            size_t next_idx = m_ds->find_next_label(m_attribute, m_ds->get_col_sorted(m_attribute, m_idx));
+            size_t next_idx = m_ds->find_next_label(m_attribute, m_ds->get_col_sorted(m_attribute, m_idx), m_idx);
             m_idx = next_idx;
             return *this;
         }
@@ -208,3 +644,15 @@ class Dataset
   public:
     SplitDatasetView split_iterator(int attribute) const { return SplitDatasetView(*this, attribute); }
 };
+
+inline Dataset TrainingContext::begin_build()
+{
+    for (size_t col = 0; col < m_cols.size(); ++col)
+    {
+        if (m_numeric.test(col))
+        {
+            std::ranges::copy(m_num_sorted[col], m_num_order[col].begin());
+        }
+    }
+    return Dataset(this, m_idx_buf.data(), m_idx_buf.size());
+}
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "criteria.hpp"
+#include "fd_io.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Data-parallel training over processes. Every worker holds a shard of the rows and all of them run the same build in
+// lockstep: a worker counts value by class for its own rows only, and a ReductionTransport sums the counts, so every
+// worker sees the counts of the whole table and makes the same split. Only counts cross the transport, never rows.
+
+enum class ReduceOp
+{
+    Sum,
+    Max,
+};
+
+// Combines an int vector of the same length on every worker element by element and leaves the result in `values` on
+// all of them. Every worker makes the same sequence of calls.
+class ReductionTransport
+{
+  public:
+    virtual ~ReductionTransport() = default;
+    virtual void all_reduce(std::span<int> values, ReduceOp op) = 0;
+};
+
+// Workers on one host in a star of Unix stream sockets. The root gathers every other worker's values, combines them in
+// worker order and sends the result back; each message is a u32 length followed by the ints, in host byte order.
+class SocketTransport final : public ReductionTransport
+{
+    std::vector<int> m_peers;
+    bool m_root;
+    std::vector<int> m_buf;
+
+    SocketTransport(std::vector<int> peers, bool root) : m_peers(std::move(peers)), m_root(root) {}
+
+    static void send(int fd, std::span<const int> values)
+    {
+        const auto len = static_cast<uint32_t>(values.size());
+        if (!write_full(fd, &len, sizeof(len)) || !write_full(fd, values.data(), values.size_bytes()))
+        {
+            throw std::runtime_error("reduction peer hung up");
+        }
+    }
+
+    static void receive(int fd, std::span<int> values)
+    {
+        uint32_t len = 0;
+        if (!read_full(fd, &len, sizeof(len)))
+        {
+            throw std::runtime_error("reduction peer hung up");
+        }
+        if (len != values.size())
+        {
+            throw std::runtime_error("workers disagree on the reduction length");
+        }
+        if (!read_full(fd, values.data(), values.size_bytes()))
+        {
+            throw std::runtime_error("reduction peer hung up");
+        }
+    }
+
+  public:
+    // The root, with one socket per other worker. Takes ownership of the sockets.
+    static SocketTransport root(std::vector<int> peers) { return {std::move(peers), true}; }
+
+    // Any other worker, with its socket to the root. Takes ownership of the socket.
+    static SocketTransport worker(int root) { return {{root}, false}; }
+
+    SocketTransport(const SocketTransport &) = delete;
+    SocketTransport &operator=(const SocketTransport &) = delete;
+    SocketTransport(SocketTransport &&other) noexcept
+        : m_peers(std::exchange(other.m_peers, {})), m_root(other.m_root), m_buf(std::move(other.m_buf))
+    {
+    }
+    SocketTransport &operator=(SocketTransport &&) = delete;
+
+    ~SocketTransport() override
+    {
+        for (const int fd : m_peers)
+        {
+            ::close(fd);
+        }
+    }
+
+    void all_reduce(std::span<int> values, ReduceOp op) override
+    {
+        if (!m_root)
+        {
+            send(m_peers.front(), values);
+            receive(m_peers.front(), values);
+            return;
+        }
+
+        m_buf.resize(values.size());
+        for (const int peer : m_peers)
+        {
+            receive(peer, m_buf);
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] = op == ReduceOp::Sum ? values[i] + m_buf[i] : std::max(values[i], m_buf[i]);
+            }
+        }
+        for (const int peer : m_peers)
+        {
+            send(peer, values);
+        }
+    }
+};
+
+// Runs `work(rank, transport)` on `num_workers` processes joined by a SocketTransport: rank 0 on the calling process and
+// the others on forked children, which exit once their work returns. Returns rank 0's result. Rethrows rank 0's
+// exception, and throws std::runtime_error if a child fails.
+template <typename Work>
+inline auto fork_workers(int num_workers, Work work) -> std::invoke_result_t<Work &, int, ReductionTransport &>
+{
+    if (num_workers < 1)
+    {
+        throw std::invalid_argument("at least one worker is needed");
+    }
+
+    std::vector<std::array<int, 2>> pairs;
+    const auto close_pairs = [&pairs]
+    {
+        for (const auto &[root_end, worker_end] : pairs)
+        {
+            ::close(root_end);
+            ::close(worker_end);
+        }
+    };
+    for (int rank = 1; rank < num_workers; ++rank)
+    {
+        std::array<int, 2> pair;
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair.data()) != 0)
+        {
+            const int error = errno;
+            close_pairs();
+            throw std::system_error(error, std::generic_category(), "socketpair");
+        }
+        pairs.push_back(pair);
+    }
+
+    // Buffered output would otherwise be written once more by every child.
+    std::fflush(nullptr);
+
+    std::vector<pid_t> children;
+    int fork_error = 0;
+    for (size_t rank = 1; rank < static_cast<size_t>(num_workers); ++rank)
+    {
+        const pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            for (size_t i = 0; i < pairs.size(); ++i)
+            {
+                ::close(pairs[i][0]);
+                if (i != rank - 1)
+                    ::close(pairs[i][1]);
+            }
+
+            int status = 1;
+            try
+            {
+                auto transport = SocketTransport::worker(pairs[rank - 1][1]);
+                work(static_cast<int>(rank), transport);
+                status = 0;
+            }
+            catch (...)
+            {
+            }
+            ::_exit(status);
+        }
+        if (pid < 0)
+        {
+            fork_error = errno;
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    std::vector<int> peers;
+    for (const auto &[root_end, worker_end] : pairs)
+    {
+        ::close(worker_end);
+        peers.push_back(root_end);
+    }
+
+    using Result = std::invoke_result_t<Work &, int, ReductionTransport &>;
+    std::optional<Result> result;
+    std::exception_ptr error;
+    {
+        // Closing the sockets when rank 0 is done, or has failed, releases any child still waiting on it.
+        auto transport = SocketTransport::root(std::move(peers));
+        if (fork_error == 0)
+        {
+            try
+            {
+                result.emplace(work(0, transport));
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    bool children_ok = true;
+    for (const pid_t pid : children)
+    {
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        children_ok = children_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    if (fork_error != 0)
+    {
+        throw std::system_error(fork_error, std::generic_category(), "fork");
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    if (!children_ok)
+    {
+        throw std::runtime_error("a training worker failed");
+    }
+    return std::move(*result);
+}
+
+// Scores splitting a node on an attribute from its value-by-class count table, `num_classes` counts per value, like
+// split_score on the node's rows sorted by that attribute: values in ascending order, with the same early exit.
+template <typename Criterion>
+inline float table_split_score(std::span<const int> table, std::span<const int> totals, size_t num_classes, int node_total, float parent_impurity,
+                               float bound)
+{
+    size_t last = totals.size() - 1;
+    while (totals[last] == 0)
+    {
+        --last;
+    }
+
+    float total_impurity = 0;
+    float split_info = 0;
+    for (size_t v = 0; v <= last; ++v)
+    {
+        if (totals[v] == 0)
+            continue;
+
+        total_impurity += Criterion::impurity(totals[v], table.subspan(v * num_classes, num_classes));
+        if constexpr (Criterion::uses_split_info)
+        {
+            split_info += Criterion::split_info(totals[v], node_total);
+        }
+        if constexpr (Criterion::exits_early)
+        {
+            if (v < last && total_impurity >= bound)
+                return std::numeric_limits<float>::infinity();
+        }
+    }
+    return Criterion::score(total_impurity, parent_impurity, split_info);
+}
+
+// One worker's side of a sharded build. The build goes a level at a time: every worker counts the rows it holds in each
+// open node of the level, one all_reduce sums the tables of the whole level, and every worker then decides all of the
+// level's nodes the same way and partitions its own rows into their children. A build takes one round trip per level
+// plus one to agree on the shape of the data.
+template <typename Criterion = Entropy>
+class ShardedBuilder
+{
+    struct OpenNode
+    {
+        std::vector<int> rows;
+        std::bitset<64> used;
+        int parent_mode;
+        int depth;
+        size_t slot;
+    };
+
+    struct BuiltNode
+    {
+        NodeStats stats;
+        int attr = -1;
+        std::vector<size_t> children;
+        std::vector<int> labels;
+    };
+
+    std::vector<std::vector<int>> m_cols;
+    std::vector<int> m_target;
+    ReductionTransport &m_transport;
+    BuildOptions m_options;
+    size_t m_num_attrs = 0;
+    size_t m_num_values = 0;
+    size_t m_num_classes = 0;
+    std::vector<int> m_counts;
+    std::vector<BuiltNode> m_built;
+
+  public:
+    ShardedBuilder(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, ReductionTransport &transport,
+                   const BuildOptions &options)
+        : m_target(target_data), m_transport(transport), m_options(options)
+    {
+        if (row_data.size() != target_data.size())
+        {
+            throw std::invalid_argument("one label per row is needed");
+        }
+
+        const size_t ncols = row_data.empty() ? 0 : row_data[0].size();
+        m_cols.assign(ncols, std::vector<int>(row_data.size()));
+        int max_value = 0;
+        for (size_t i = 0; i < row_data.size(); ++i)
+        {
+            for (size_t j = 0; j < ncols; ++j)
+            {
+                m_cols[j][i] = row_data[i][j];
+                max_value = std::max(max_value, row_data[i][j]);
+            }
+        }
+        const int max_class = m_target.empty() ? 0 : std::ranges::max(m_target);
+
+        // Empty shards know nothing of the width, so they report the lowest one possible.
+        std::array<int, 4> shape{INT_MIN, INT_MIN, max_value, max_class};
+        if (!row_data.empty())
+        {
+            shape[0] = static_cast<int>(ncols);
+            shape[1] = -static_cast<int>(ncols);
+        }
+        m_transport.all_reduce(shape, ReduceOp::Max);
+        if (shape[0] >= 0 && shape[0] != -shape[1])
+        {
+            throw std::invalid_argument("shards have different numbers of attributes");
+        }
+        m_num_attrs = static_cast<size_t>(std::max(shape[0], 0));
+        m_num_values = static_cast<size_t>(shape[2]) + 1;
+        m_num_classes = static_cast<size_t>(shape[3]) + 1;
+        if (m_cols.empty())
+        {
+            m_cols.resize(m_num_attrs);
+        }
+    }
+
+    Node build()
+    {
+        m_built.assign(1, {});
+        std::vector<OpenNode> level(1, OpenNode{{}, {}, 0, 0, 0});
+        level[0].rows.resize(m_target.size());
+        for (size_t i = 0; i < m_target.size(); ++i)
+        {
+            level[0].rows[i] = static_cast<int>(i);
+        }
+
+        while (!level.empty())
+        {
+            std::vector<size_t> offsets(level.size() + 1);
+            for (size_t k = 0; k < level.size(); ++k)
+            {
+                offsets[k + 1] = offsets[k] + table_size(level[k]);
+            }
+            m_counts.assign(offsets.back(), 0);
+            for (size_t k = 0; k < level.size(); ++k)
+            {
+                count_rows(level[k], offsets[k]);
+            }
+            m_transport.all_reduce(m_counts, ReduceOp::Sum);
+
+            std::vector<OpenNode> next;
+            for (size_t k = 0; k < level.size(); ++k)
+            {
+                decide(level[k], offsets[k], next);
+            }
+            level = std::move(next);
+        }
+        return assemble(0);
+    }
+
+  private:
+    bool may_split(const OpenNode &node) const { return node.depth < m_options.max_depth && node.used.count() < m_num_attrs; }
+
+    // A node's table: its class counts, then, if it may split, a value-by-class table per unused attribute.
+    size_t table_size(const OpenNode &node) const
+    {
+        const size_t tables = may_split(node) ? m_num_attrs - node.used.count() : 0;
+        return m_num_classes * (1 + tables * m_num_values);
+    }
+
+    void count_rows(const OpenNode &node, size_t offset)
+    {
+        int *class_counts = m_counts.data() + offset;
+        for (const int row : node.rows)
+        {
+            ++class_counts[m_target[static_cast<size_t>(row)]];
+        }
+        if (!may_split(node))
+            return;
+
+        int *table = class_counts + m_num_classes;
+        for (size_t col = 0; col < m_num_attrs; ++col)
+        {
+            if (node.used.test(col))
+                continue;
+
+            const auto &values = m_cols[col];
+            for (const int row : node.rows)
+            {
+                const auto r = static_cast<size_t>(row);
+                ++table[static_cast<size_t>(values[r]) * m_num_classes + static_cast<size_t>(m_target[r])];
+            }
+            table += m_num_values * m_num_classes;
+        }
+    }
+
+    std::vector<int> value_totals(std::span<const int> table) const
+    {
+        std::vector<int> totals(m_num_values);
+        for (size_t v = 0; v < m_num_values; ++v)
+        {
+            for (size_t label = 0; label < m_num_classes; ++label)
+            {
+                totals[v] += table[v * m_num_classes + label];
+            }
+        }
+        return totals;
+    }
+
+    // The same decision id3 makes for the node's rows, taken from the summed counts.
+    void decide(OpenNode &node, size_t offset, std::vector<OpenNode> &next)
+    {
+        const std::span<const int> class_counts(m_counts.data() + offset, m_num_classes);
+        NodeStats stats;
+        for (size_t label = 0; label < m_num_classes; ++label)
+        {
+            stats.num_samples += class_counts[label];
+            if (class_counts[label] > stats.mode_count)
+            {
+                stats.mode_count = class_counts[label];
+                stats.mode_label = static_cast<int>(label);
+            }
+        }
+        if (stats.num_samples == 0)
+        {
+            stats = {0, 0, node.parent_mode};
+        }
+        m_built[node.slot].stats = stats;
+
+        if (stats.num_samples == 0 || stats.mode_count == stats.num_samples || node.used.count() == m_num_attrs ||
+            stats.num_samples <= m_options.min_samples_split || node.depth >= m_options.max_depth)
+        {
+            return;
+        }
+
+        float parent_impurity = 0;
+        if constexpr (Criterion::uses_parent_impurity)
+        {
+            parent_impurity = Criterion::impurity(stats.num_samples, class_counts);
+        }
+
+        const size_t table_len = m_num_values * m_num_classes;
+        float best_score = std::numeric_limits<float>::max();
+        int best_attr = -1;
+        std::span<const int> best_table;
+        size_t slot = 0;
+        for (size_t col = 0; col < m_num_attrs; ++col)
+        {
+            if (node.used.test(col))
+                continue;
+
+            const auto table = std::span<const int>(m_counts).subspan(offset + m_num_classes + slot++ * table_len, table_len);
+            const auto totals = value_totals(table);
+            if (std::ranges::count_if(totals, [](int total) { return total > 0; }) <= 1)
+                continue;
+
+            const auto score = table_split_score<Criterion>(table, totals, m_num_classes, stats.num_samples, parent_impurity, best_score);
+            if (score < best_score)
+            {
+                best_score = score;
+                best_attr = static_cast<int>(col);
+                best_table = table;
+            }
+        }
+        if (best_attr < 0)
+            return;
+
+        const auto attr = static_cast<size_t>(best_attr);
+        std::vector<std::vector<int>> buckets(m_num_values);
+        for (const int row : node.rows)
+        {
+            buckets[static_cast<size_t>(m_cols[attr][static_cast<size_t>(row)])].push_back(row);
+        }
+        node.rows = {};
+
+        auto used = node.used;
+        used.set(attr);
+        m_built[node.slot].attr = best_attr;
+        const auto totals = value_totals(best_table);
+        for (size_t v = 0; v < m_num_values; ++v)
+        {
+            if (totals[v] == 0)
+                continue;
+
+            const size_t child = m_built.size();
+            m_built.emplace_back();
+            m_built[node.slot].children.push_back(child);
+            m_built[node.slot].labels.push_back(static_cast<int>(v));
+            next.push_back({std::move(buckets[v]), used, stats.mode_label, node.depth + 1, child});
+        }
+    }
+
+    Node assemble(size_t slot)
+    {
+        const auto &built = m_built[slot];
+        if (built.attr < 0)
+        {
+            auto leaf = Node::make_leaf(built.stats.mode_label);
+            leaf.set_stats(built.stats);
+            return leaf;
+        }
+
+        std::vector<Node> children;
+        for (size_t i = 0; i < built.children.size(); ++i)
+        {
+            auto child = assemble(built.children[i]);
+            child.set_inter_label(built.labels[i]);
+            children.push_back(std::move(child));
+        }
+        auto node = Node::make_inter(built.attr, std::move(children));
+        node.set_stats(built.stats);
+        return node;
+    }
+};
+
+// Builds on this worker's shard of the rows together with the other workers on `transport`, each calling it with its
+// own shard. Every worker returns the tree build_tree makes on all the shards' rows put together. Only categorical data,
+// and only min_samples_split and max_depth of the BuildOptions apply.
+template <typename Criterion = Entropy>
+inline Node build_tree_sharded(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, ReductionTransport &transport,
+                               const BuildOptions &options = {})
+{
+    return ShardedBuilder<Criterion>(row_data, target_data, transport, options).build();
+}
+
+// Splits the rows into `num_workers` contiguous shards and builds on them with fork_workers.
+template <typename Criterion = Entropy>
+inline Node build_tree_forked(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, int num_workers,
+                              const BuildOptions &options = {})
+{
+    if (row_data.size() != target_data.size())
+    {
+        throw std::invalid_argument("one label per row is needed");
+    }
+
+    return fork_workers(num_workers,
+                        [&](int rank, ReductionTransport &transport)
+                        {
+                            const auto n = row_data.size();
+                            const auto workers = static_cast<size_t>(num_workers);
+                            const auto begin = static_cast<std::ptrdiff_t>(n * static_cast<size_t>(rank) / workers);
+                            const auto end = static_cast<std::ptrdiff_t>(n * (static_cast<size_t>(rank) + 1) / workers);
+                            const std::vector<std::vector<int>> rows(row_data.begin() + begin, row_data.begin() + end);
+                            const std::vector<int> target(target_data.begin() + begin, target_data.begin() + end);
+                            return build_tree_sharded<Criterion>(rows, target, transport, options);
+                        });
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Blocking whole-buffer reads and writes on a file descriptor, retried across short transfers and signals. Both return
+// false once the peer is gone.
+inline bool read_full(int fd, void *buf, size_t len)
+{
+    auto *p = static_cast<char *>(buf);
+    while (len > 0)
+    {
+        const auto n = ::read(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool write_full(int fd, const void *buf, size_t len)
+{
+    const auto *p = static_cast<const char *>(buf);
+    while (len > 0)
+    {
+        auto n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == ENOTSOCK)
+        {
+            n = ::write(fd, p, len);
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "criteria.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// id3 for data whose shape is known at compile time: NumAttrs categorical attributes with values in [0, MaxValue] and
+// labels in [0, NumClasses). Every count table is a fixed-size std::array on the stack and the attribute loops have a
+// constant trip count, so for small data the build is a few tight passes with nothing sized at runtime. One pass over
+// a node's rows fills the value-by-class table of every attribute at once; nothing is sorted until the rows are
+// partitioned for the children.
+//
+// Builds the same tree as the generic build_tree on the same rows. Only min_samples_split and max_depth of the
+// BuildOptions apply. Data that does not fit the schema throws std::invalid_argument; the generic builder takes
+// anything. A builder keeps its buffers between builds, which is what retraining many small models wants.
+template <int NumAttrs, int MaxValue, int NumClasses, typename Criterion = Entropy>
+class FixedSchemaBuilder
+{
+    static_assert(NumAttrs > 0 && NumAttrs <= 64);
+    static_assert(MaxValue >= 0 && MaxValue < 256);
+    static_assert(NumClasses > 0 && NumClasses <= 256);
+
+    static constexpr size_t num_values = MaxValue + 1;
+
+    using Row = std::array<uint8_t, NumAttrs>;
+    using ClassCounts = std::array<int, NumClasses>;
+    using ValueTable = std::array<ClassCounts, num_values>;
+
+    std::vector<Row> m_rows;
+    std::vector<uint8_t> m_target;
+    std::vector<int> m_idxs;
+    std::vector<int> m_scratch;
+    BuildOptions m_options;
+
+  public:
+    // Whether `row_data` and `target` fit the schema.
+    static bool fits(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target)
+    {
+        if (row_data.size() != target.size())
+            return false;
+
+        for (size_t i = 0; i < row_data.size(); ++i)
+        {
+            if (row_data[i].size() != NumAttrs || target[i] < 0 || target[i] >= NumClasses)
+                return false;
+
+            for (const auto v : row_data[i])
+            {
+                if (v < 0 || v > MaxValue)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    Node build(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target, const BuildOptions &options = {})
+    {
+        if (!fits(row_data, target))
+        {
+            throw std::invalid_argument("data does not fit the fixed schema");
+        }
+
+        const size_t n = row_data.size();
+        m_rows.resize(n);
+        m_target.resize(n);
+        m_idxs.resize(n);
+        m_scratch.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t a = 0; a < NumAttrs; ++a)
+            {
+                m_rows[i][a] = static_cast<uint8_t>(row_data[i][a]);
+            }
+            m_target[i] = static_cast<uint8_t>(target[i]);
+            m_idxs[i] = static_cast<int>(i);
+        }
+        m_options = options;
+
+        return id3(0, n, {}, 0, 0);
+    }
+
+  private:
+    // Impurity summed over the non-empty values of `table`, in value order like split_score. Stops at `bound` the way
+    // split_score does for criteria that exit early, returning infinity.
+    static float split_score(const ValueTable &table, const std::array<int, num_values> &totals, int node_total, float parent_impurity, float bound)
+    {
+        size_t last = MaxValue;
+        while (totals[last] == 0)
+        {
+            --last;
+        }
+
+        float total_impurity = 0;
+        float split_info = 0;
+        for (size_t v = 0; v <= last; ++v)
+        {
+            if (totals[v] == 0)
+                continue;
+
+            total_impurity += Criterion::impurity(totals[v], table[v]);
+            if constexpr (Criterion::uses_split_info)
+            {
+                split_info += Criterion::split_info(totals[v], node_total);
+            }
+            if constexpr (Criterion::exits_early)
+            {
+                if (v < last && total_impurity >= bound)
+                    return std::numeric_limits<float>::infinity();
+            }
+        }
+        return Criterion::score(total_impurity, parent_impurity, split_info);
+    }
+
+    Node id3(size_t begin, size_t end, std::bitset<NumAttrs> used, int parent_mode, int depth)
+    {
+        if (begin == end)
+        {
+            auto leaf = Node::make_leaf(parent_mode);
+            leaf.set_stats({0, 0, parent_mode});
+            return leaf;
+        }
+
+        ClassCounts class_counts{};
+        std::array<ValueTable, NumAttrs> tables{};
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto idx = static_cast<size_t>(m_idxs[i]);
+            const Row &row = m_rows[idx];
+            const auto label = m_target[idx];
+            ++class_counts[label];
+            [&]<size_t... A>(std::index_sequence<A...>) { (++tables[A][row[A]][label], ...); }(std::make_index_sequence<NumAttrs>{});
+        }
+
+        const int num_samples = static_cast<int>(end - begin);
+        NodeStats stats{.num_samples = num_samples};
+        for (int label = 0; label < NumClasses; ++label)
+        {
+            if (class_counts[label] > stats.mode_count)
+            {
+                stats.mode_count = class_counts[label];
+                stats.mode_label = label;
+            }
+        }
+        const auto with_stats = [&stats](Node node)
+        {
+            node.set_stats(stats);
+            return node;
+        };
+
+        if (stats.mode_count == num_samples || used.all() || num_samples <= m_options.min_samples_split || depth >= m_options.max_depth)
+        {
+            return with_stats(Node::make_leaf(stats.mode_label));
+        }
+
+        float parent_impurity = 0;
+        if constexpr (Criterion::uses_parent_impurity)
+        {
+            parent_impurity = Criterion::impurity(num_samples, class_counts);
+        }
+
+        float best_score = std::numeric_limits<float>::max();
+        int best_attr = -1;
+        std::array<int, num_values> best_totals{};
+        for (size_t a = 0; a < NumAttrs; ++a)
+        {
+            if (used.test(a))
+                continue;
+
+            std::array<int, num_values> totals{};
+            int present = 0;
+            for (size_t v = 0; v < num_values; ++v)
+            {
+                for (const auto c : tables[a][v])
+                {
+                    totals[v] += c;
+                }
+                present += totals[v] > 0;
+            }
+            if (present <= 1)
+                continue;
+
+            const auto score = split_score(tables[a], totals, num_samples, parent_impurity, best_score);
+            if (score < best_score)
+            {
+                best_score = score;
+                best_attr = static_cast<int>(a);
+                best_totals = totals;
+            }
+        }
+
+        if (best_attr < 0)
+        {
+            return with_stats(Node::make_leaf(stats.mode_label));
+        }
+
+        // Stable partition of the node's rows by the chosen attribute's value.
+        const auto attr = static_cast<size_t>(best_attr);
+        std::array<size_t, num_values + 1> offsets{};
+        for (size_t v = 0; v < num_values; ++v)
+        {
+            offsets[v + 1] = offsets[v] + static_cast<size_t>(best_totals[v]);
+        }
+        auto next = offsets;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto idx = m_idxs[i];
+            m_scratch[begin + next[m_rows[static_cast<size_t>(idx)][attr]]++] = idx;
+        }
+        std::copy(m_scratch.begin() + static_cast<std::ptrdiff_t>(begin), m_scratch.begin() + static_cast<std::ptrdiff_t>(end),
+                  m_idxs.begin() + static_cast<std::ptrdiff_t>(begin));
+
+        used.set(attr);
+        std::vector<Node> children;
+        for (size_t v = 0; v < num_values; ++v)
+        {
+            if (best_totals[v] == 0)
+                continue;
+
+            auto child = id3(begin + offsets[v], begin + offsets[v + 1], used, stats.mode_label, depth + 1);
+            child.set_inter_label(static_cast<int>(v));
+            children.push_back(std::move(child));
+        }
+        return with_stats(Node::make_inter(best_attr, std::move(children)));
+    }
+};
+
+template <int NumAttrs, int MaxValue, int NumClasses, typename Criterion = Entropy>
+inline Node build_tree(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, const BuildOptions &options)
+{
+    return FixedSchemaBuilder<NumAttrs, MaxValue, NumClasses, Criterion>().build(row_data, target_data, options);
+}
+
+template <int NumAttrs, int MaxValue, int NumClasses, typename Criterion = Entropy>
+inline Node build_tree(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, int min_samples_split = 2)
+{
+    return build_tree<NumAttrs, MaxValue, NumClasses, Criterion>(row_data, target_data, BuildOptions{.min_samples_split = min_samples_split});
+}
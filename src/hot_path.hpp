@@ -0,0 +1,83 @@
+#pragma once
+
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// Reorders the children of every categorical split in `tree` so the ones more of the row-major, `width`-value
+// `observations` pass through come first, equally busy ones keeping their order. Meant to be fed a sample of production
+// traffic: tree_predict scans children in order, so on skewed traffic most lookups then match the first child, and a
+// PackedTree built with PackedLayout::HotPath lays the busiest paths out contiguously. Predictions do not change:
+// children are matched by value, and unseen values still go to fallback_child. Threshold splits are left alone, as
+// their children's positions carry meaning. Returns how many splits had their children reordered.
+inline size_t reorder_by_traffic(Node &tree, std::span<const int> observations, size_t width)
+{
+    if (width == 0 || observations.size() % width != 0)
+    {
+        throw std::invalid_argument("observations do not hold whole rows");
+    }
+
+    std::unordered_map<const Node *, size_t> hits;
+    for (size_t row = 0; row < observations.size() / width; ++row)
+    {
+        const auto obs = observations.subspan(row * width, width);
+        const Node *node = &tree;
+        while (!node->is_leaf())
+        {
+            ++hits[node];
+            const int value = obs[node->split_attribute()];
+            if (node->is_threshold())
+            {
+                node = &node->children()[value > node->threshold()];
+                continue;
+            }
+
+            const auto child = std::ranges::find_if(node->children(), [value](const Node &n) { return n.inter_label() == value; });
+            node = child == node->children().end() ? &fallback_child(*node) : &*child;
+        }
+        ++hits[node];
+    }
+
+    // Children are counted before they move; moving a Node keeps its own children where they are.
+    const auto reorder = [&hits](auto &self, Node &node) -> size_t
+    {
+        if (node.is_leaf())
+            return 0;
+
+        auto &children = node.children();
+        std::vector<size_t> child_hits(children.size());
+        size_t moved = 0;
+        for (size_t c = 0; c < children.size(); ++c)
+        {
+            const auto it = hits.find(&children[c]);
+            child_hits[c] = it == hits.end() ? 0 : it->second;
+            moved += self(self, children[c]);
+        }
+        if (node.is_threshold())
+            return moved;
+
+        std::vector<size_t> order(children.size());
+        for (size_t c = 0; c < order.size(); ++c)
+        {
+            order[c] = c;
+        }
+        std::ranges::stable_sort(order, std::greater<>(), [&child_hits](size_t c) { return child_hits[c]; });
+        if (std::ranges::is_sorted(order))
+            return moved;
+
+        std::vector<Node> sorted;
+        sorted.reserve(children.size());
+        for (const auto c : order)
+        {
+            sorted.push_back(std::move(children[c]));
+        }
+        children = std::move(sorted);
+        return moved + 1;
+    };
+    return reorder(reorder, tree);
+}
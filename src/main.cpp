@@ -1,5 +1,6 @@
 #include "csv.h"
 #include "dataset.hpp"
+#include "serialize.hpp"
 #include "tree.hpp"
 
 #include <benchmark/benchmark.h>
@@ -74,7 +75,7 @@ std::pair<std::vector<std::vector<int>>, std::vector<int>> loadCarData()
     return {row_data, target_data};
 }
 
-int main()
+int main(int argc, char **argv)
 {
 
     auto [row_data, target_data] = loadCarData();
@@ -83,6 +84,7 @@ int main()
     float pred_time = 0;
     int correct = 0;
     int total = 0;
+    TrainingContext ctx;
     for (int i = 0; i < 10'000; ++i)
     {
         auto [train_set, test_set] = train_test_split(row_data, target_data, 0.85);
@@ -91,7 +93,8 @@ int main()
 
         const auto st = std::chrono::high_resolution_clock::now();
 
-        auto tree = build_tree(train_data, train_target);
+        ctx.assign(train_data, train_target);
+        auto tree = build_tree(ctx);
 
         const auto end = std::chrono::high_resolution_clock::now();
 
@@ -114,4 +117,10 @@ int main()
     std::cout << "Train time: " << train_time / 1'000 << " us\n";
     std::cout << "Pred time: " << pred_time / total << " us\n";
     std::cout << "Accuracy: " << static_cast<float>(correct) / total << '\n';
+
+    // Optionally write a model trained on the whole dataset, e.g. for tree_serve.
+    if (argc > 1)
+    {
+        save_tree(build_tree(row_data, target_data), std::string(argv[1]));
+    }
 }
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Publishes a model to concurrent readers without locking them out, epoch style.
+//
+// Every reader owns a slot holding the epoch it pinned the model in (0 while unpinned). Pinning is two atomic operations:
+// store the current epoch into the slot, then load the model pointer. Publishing swaps the pointer, moves to a new
+// epoch and waits until every slot is either unpinned or pinned in the new epoch; readers that could still hold the
+// old model are then gone and it is destroyed. Only publishers ever wait.
+template <typename Model>
+class ModelHandle
+{
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> claimed{false};
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_num_slots;
+    alignas(64) std::atomic<const Model *> m_current;
+    alignas(64) std::atomic<uint64_t> m_epoch{1};
+    std::mutex m_publish_mutex;
+
+  public:
+    class Reader;
+
+    // A model pinned by a reader; it stays alive and unchanged until the pin is dropped.
+    class Pin
+    {
+        friend class Reader;
+
+        Slot *m_slot = nullptr;
+        const Model *m_model = nullptr;
+
+        Pin(Slot *slot, const Model *model) : m_slot(slot), m_model(model) {}
+
+      public:
+        Pin(Pin &&other) noexcept : m_slot(std::exchange(other.m_slot, nullptr)), m_model(other.m_model) {}
+
+        Pin(const Pin &) = delete;
+        Pin &operator=(const Pin &) = delete;
+        Pin &operator=(Pin &&) = delete;
+
+        ~Pin()
+        {
+            if (m_slot)
+            {
+                m_slot->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        const Model &operator*() const { return *m_model; }
+
+        const Model *operator->() const { return m_model; }
+    };
+
+    // One reader slot, meant to be kept by a thread for as long as it reads. A reader holds at most one pin at a time.
+    class Reader
+    {
+        friend class ModelHandle;
+
+        ModelHandle *m_handle = nullptr;
+        Slot *m_slot = nullptr;
+
+        Reader(ModelHandle *handle, Slot *slot) : m_handle(handle), m_slot(slot) {}
+
+      public:
+        Reader(Reader &&other) noexcept : m_handle(other.m_handle), m_slot(std::exchange(other.m_slot, nullptr)) {}
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+        Reader &operator=(Reader &&) = delete;
+
+        ~Reader()
+        {
+            if (m_slot)
+            {
+                m_slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+
+        Pin pin() const
+        {
+            assert(m_slot->epoch.load(std::memory_order_relaxed) == 0 && "reader already holds a pin");
+            m_slot->epoch.store(m_handle->m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            return Pin(m_slot, m_handle->m_current.load(std::memory_order_seq_cst));
+        }
+    };
+
+    explicit ModelHandle(std::unique_ptr<const Model> initial, size_t max_readers = 64)
+        : m_slots(std::make_unique<Slot[]>(max_readers)), m_num_slots(max_readers), m_current(initial.release())
+    {
+    }
+
+    ModelHandle(const ModelHandle &) = delete;
+    ModelHandle &operator=(const ModelHandle &) = delete;
+
+    // No reader may outlive the handle.
+    ~ModelHandle() { delete m_current.load(); }
+
+    Reader reader()
+    {
+        for (size_t i = 0; i < m_num_slots; ++i)
+        {
+            bool expected = false;
+            if (!m_slots[i].claimed.load(std::memory_order_relaxed) && m_slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return Reader(this, &m_slots[i]);
+            }
+        }
+        throw std::runtime_error("no free model reader slot");
+    }
+
+    // Makes `next` visible to every subsequent pin, then destroys the previous model once no reader can still see it.
+    void publish(std::unique_ptr<const Model> next)
+    {
+        std::lock_guard lock(m_publish_mutex);
+
+        const Model *old = m_current.exchange(next.release(), std::memory_order_seq_cst);
+        const uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+        for (size_t i = 0; i < m_num_slots; ++i)
+        {
+            while (true)
+            {
+                const uint64_t pinned = m_slots[i].epoch.load(std::memory_order_seq_cst);
+                if (pinned == 0 || pinned >= epoch)
+                    break;
+                std::this_thread::yield();
+            }
+        }
+
+        delete old;
+    }
+};
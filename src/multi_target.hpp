@@ -0,0 +1,287 @@
+#pragma once
+
+#include "criteria.hpp"
+#include "dataset.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <map>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Builds one tree per label column over the same rows at once. The targets whose trees agree so far move through the
+// recursion together: they share the node's rows, every sort of them and the pass that counts each partition, which
+// tallies all their labels in one sweep. A node where they choose different splits re-sorts its rows once per chosen
+// attribute and carries on with each group separately; a target left on its own finishes its subtree with the usual
+// id3, on the context's label column swapped for its own. A batch of related models costs about one build while they
+// agree.
+//
+// Trees are the ones build_tree makes for each target on its own. Only min_samples_split and max_depth of the
+// BuildOptions apply, and the context must not have numeric columns.
+template <typename Criterion = Entropy>
+class MultiTargetBuilder
+{
+    TrainingContext &m_ctx;
+    Dataset m_root;
+    const std::vector<std::vector<int>> &m_targets;
+    const BuildOptions &m_options;
+    BuildOptions m_single_options;
+    // Where each target's counts start in a flat count table, and its number of classes.
+    std::vector<size_t> m_offsets;
+    std::vector<size_t> m_num_classes;
+    std::vector<int> m_counts;
+
+  public:
+    MultiTargetBuilder(TrainingContext &ctx, const std::vector<std::vector<int>> &targets, const BuildOptions &options)
+        : m_ctx(ctx), m_root(ctx.begin_build()), m_targets(targets), m_options(options),
+          m_single_options{.min_samples_split = options.min_samples_split, .max_depth = options.max_depth}
+    {
+        if (ctx.has_numeric())
+        {
+            throw std::invalid_argument("multi-target builds need categorical columns");
+        }
+
+        size_t offset = 0;
+        for (const auto &target : targets)
+        {
+            if (target.size() != ctx.num_rows())
+            {
+                throw std::invalid_argument("one label per row is needed in every target");
+            }
+            m_offsets.push_back(offset);
+            m_num_classes.push_back(target.empty() ? 1 : static_cast<size_t>(std::ranges::max(target)) + 1);
+            offset += m_num_classes.back();
+        }
+        m_counts.assign(offset, 0);
+    }
+
+    std::vector<Node> build()
+    {
+        std::vector<int> all(m_targets.size());
+        for (size_t t = 0; t < all.size(); ++t)
+        {
+            all[t] = static_cast<int>(t);
+        }
+
+        // Targets that finish on their own swap the context's labels, which are put back afterwards.
+        std::vector<int> own_target(m_ctx.num_rows());
+        for (size_t row = 0; row < own_target.size(); ++row)
+        {
+            own_target[row] = m_ctx.target(static_cast<int>(row));
+        }
+        auto trees = id3(m_root, all, std::vector<int>(all.size(), 0), 0, 0);
+        m_ctx.set_target(own_target);
+        return trees;
+    }
+
+  private:
+    std::span<const int> counts(int t) const { return {m_counts.data() + m_offsets[t], m_num_classes[t]}; }
+
+    void clear_counts(std::span<const int> targets)
+    {
+        for (const int t : targets)
+        {
+            std::fill_n(m_counts.begin() + static_cast<std::ptrdiff_t>(m_offsets[t]), m_num_classes[t], 0);
+        }
+    }
+
+    // Adds the node's rows [begin, end) in its current order to the counts of `targets`; returns their weight.
+    int count_rows(const Dataset &ds, std::span<const int> targets, size_t begin, size_t end)
+    {
+        int weight = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto row = static_cast<size_t>(ds.row_index(i));
+            const int w = ds.get_weight_sorted(i);
+            for (const int t : targets)
+            {
+                m_counts[m_offsets[t] + static_cast<size_t>(m_targets[t][row])] += w;
+            }
+            weight += w;
+        }
+        return weight;
+    }
+
+    // The result is in the order of `targets`.
+    std::vector<Node> id3(Dataset dataset, std::span<const int> targets, std::span<const int> parent_modes, std::bitset<64> used, int depth)
+    {
+        std::vector<Node> trees;
+        trees.reserve(targets.size());
+        if (targets.size() == 1)
+        {
+            m_ctx.set_target(m_targets[static_cast<size_t>(targets.front())]);
+            trees.push_back(::id3<Criterion>(dataset, used, parent_modes.front(), m_single_options, depth));
+            return trees;
+        }
+        if (dataset.num_rows() == 0)
+        {
+            for (const int mode : parent_modes)
+            {
+                auto leaf = Node::make_leaf(mode);
+                leaf.set_stats({0, 0, mode});
+                trees.push_back(std::move(leaf));
+            }
+            return trees;
+        }
+
+        const int num_samples = count_rows(dataset, targets, 0, dataset.num_rows());
+        std::vector<NodeStats> stats(targets.size(), NodeStats{.num_samples = num_samples});
+        std::vector<float> parent_impurity(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            const auto cnts = counts(targets[i]);
+            for (size_t label = 0; label < cnts.size(); ++label)
+            {
+                if (cnts[label] > stats[i].mode_count)
+                {
+                    stats[i].mode_count = cnts[label];
+                    stats[i].mode_label = static_cast<int>(label);
+                }
+            }
+            if constexpr (Criterion::uses_parent_impurity)
+            {
+                parent_impurity[i] = Criterion::impurity(num_samples, cnts);
+            }
+        }
+        clear_counts(targets);
+
+        const bool out_of_attributes = used.count() == dataset.num_attributes();
+        const bool too_small = num_samples <= m_options.min_samples_split || depth >= m_options.max_depth;
+
+        // Targets still splitting; the others become leaves.
+        std::vector<size_t> open;
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            if (stats[i].mode_count != num_samples && !out_of_attributes && !too_small)
+            {
+                open.push_back(i);
+            }
+        }
+
+        std::vector<float> best_score(targets.size(), std::numeric_limits<float>::max());
+        std::vector<int> best_attr(targets.size(), -1);
+        std::vector<int> open_targets;
+        for (const auto i : open)
+        {
+            open_targets.push_back(targets[i]);
+        }
+        for (size_t col = 0; col < dataset.num_attributes() && !open.empty(); ++col)
+        {
+            if (used.test(col) || dataset.is_constant(col))
+                continue;
+
+            dataset.sort_by(col);
+            std::vector<float> total_impurity(open.size());
+            std::vector<float> split_info(open.size());
+            size_t begin = 0;
+            while (begin < dataset.num_rows())
+            {
+                const size_t end = dataset.find_next_label(static_cast<int>(col), dataset.get_col_sorted(static_cast<int>(col), begin), begin);
+                const int total = count_rows(dataset, open_targets, begin, end);
+                if (total > 0)
+                {
+                    for (size_t k = 0; k < open.size(); ++k)
+                    {
+                        total_impurity[k] += Criterion::impurity(total, counts(open_targets[k]));
+                        if constexpr (Criterion::uses_split_info)
+                        {
+                            split_info[k] += Criterion::split_info(total, num_samples);
+                        }
+                    }
+                    clear_counts(open_targets);
+                }
+                begin = end;
+
+                // Like split_score, give up on the column once no target can still prefer it.
+                if constexpr (Criterion::exits_early)
+                {
+                    const auto beaten = [&](size_t k) { return total_impurity[k] >= best_score[open[k]]; };
+                    if (begin < dataset.num_rows() && std::ranges::all_of(std::views::iota(size_t{0}, open.size()), beaten))
+                    {
+                        std::ranges::fill(total_impurity, std::numeric_limits<float>::infinity());
+                        break;
+                    }
+                }
+            }
+
+            for (size_t k = 0; k < open.size(); ++k)
+            {
+                const auto i = open[k];
+                const auto score = Criterion::score(total_impurity[k], parent_impurity[i], split_info[k]);
+                if (score < best_score[i])
+                {
+                    best_score[i] = score;
+                    best_attr[i] = static_cast<int>(col);
+                }
+            }
+        }
+
+        // Targets that split, grouped by the attribute they chose.
+        std::map<int, std::vector<size_t>> groups;
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            if (best_attr[i] >= 0)
+            {
+                groups[best_attr[i]].push_back(i);
+            }
+        }
+
+        std::vector<std::vector<Node>> children(targets.size());
+        for (const auto &[attr, members] : groups)
+        {
+            std::vector<int> group_targets;
+            std::vector<int> group_modes;
+            for (const auto i : members)
+            {
+                group_targets.push_back(targets[i]);
+                group_modes.push_back(stats[i].mode_label);
+            }
+
+            dataset.sort_by(static_cast<size_t>(attr));
+            auto child_used = used;
+            child_used.set(static_cast<size_t>(attr));
+            for (const auto split_ds : dataset.split_iterator(attr))
+            {
+                const auto label = split_ds.get_col_sorted(attr, 0);
+                auto subtrees = id3(split_ds, group_targets, group_modes, child_used, depth + 1);
+                for (size_t k = 0; k < members.size(); ++k)
+                {
+                    subtrees[k].set_inter_label(label);
+                    children[members[k]].push_back(std::move(subtrees[k]));
+                }
+            }
+        }
+
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            auto node = best_attr[i] < 0 ? Node::make_leaf(stats[i].mode_label) : Node::make_inter(best_attr[i], std::move(children[i]));
+            node.set_stats(stats[i]);
+            trees.push_back(std::move(node));
+        }
+        return trees;
+    }
+};
+
+// One tree per entry of `targets`, each a label column over the rows selected in `ctx`.
+template <typename Criterion = Entropy>
+inline std::vector<Node> build_trees(TrainingContext &ctx, const std::vector<std::vector<int>> &targets, const BuildOptions &options = {})
+{
+    return MultiTargetBuilder<Criterion>(ctx, targets, options).build();
+}
+
+template <typename Criterion = Entropy>
+inline std::vector<Node> build_trees(const std::vector<std::vector<int>> &row_data, const std::vector<std::vector<int>> &targets,
+                                     const BuildOptions &options = {})
+{
+    if (targets.empty())
+    {
+        return {};
+    }
+    TrainingContext ctx(row_data, targets.front());
+    return build_trees<Criterion>(ctx, targets, options);
+}
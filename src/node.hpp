@@ -2,15 +2,31 @@
 
 #include <vector>
 
+// What a node saw during training: how many rows reached it and how many of those carry its mode label. Post-build
+// passes such as pruning work from these instead of going back to the training data.
+struct NodeStats
+{
+    int num_samples = 0;
+    int mode_count = 0;
+    int mode_label = 0;
+
+    int errors() const { return num_samples - mode_count; }
+
+    bool operator==(const NodeStats &) const = default;
+};
+
 class Node
 {
     std::vector<Node> m_children;
     int m_label_or_attr;
-    int m_inter_label;
+    int m_inter_label = -1;
+    int m_threshold = 0;
+    bool m_is_threshold = false;
+    NodeStats m_stats;
 
     Node(int label) : m_label_or_attr(label) {}
 
-    Node(int attr, std::vector<Node> children, int inter_label) : m_label_or_attr(attr), m_children(std::move(children)), m_inter_label(inter_label) {}
+    Node(int attr, std::vector<Node> children, int inter_label) : m_children(std::move(children)), m_label_or_attr(attr), m_inter_label(inter_label) {}
 
   public:
     bool is_leaf() const { return m_children.empty(); }
@@ -25,9 +41,42 @@ class Node
 
     int inter_label() const { return m_inter_label; }
 
+    // Threshold nodes split a numeric attribute in two: children()[0] takes values <= threshold(), children()[1] the rest.
+    bool is_threshold() const { return m_is_threshold; }
+
+    int threshold() const { return m_threshold; }
+
     void set_inter_label(int l) { m_inter_label = l; }
 
+    const NodeStats &stats() const { return m_stats; }
+
+    void set_stats(const NodeStats &stats) { m_stats = stats; }
+
+    // Drops the subtree below this node so it predicts its training mode label.
+    void collapse()
+    {
+        m_children.clear();
+        m_label_or_attr = m_stats.mode_label;
+        m_threshold = 0;
+        m_is_threshold = false;
+    }
+
+    bool operator==(const Node &) const = default;
+
     static Node make_leaf(int label) { return Node{label}; }
 
     static Node make_inter(int attribute, std::vector<Node> children) { return Node{attribute, std::move(children), -1}; }
+
+    static Node make_threshold(int attribute, int threshold, Node left, Node right)
+    {
+        std::vector<Node> children;
+        children.reserve(2);
+        children.push_back(std::move(left));
+        children.push_back(std::move(right));
+
+        Node n{attribute, std::move(children), -1};
+        n.m_threshold = threshold;
+        n.m_is_threshold = true;
+        return n;
+    }
 };
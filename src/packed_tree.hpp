@@ -0,0 +1,190 @@
+#pragma once
+
+#include "node.hpp"
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Where a PackedTree puts its nodes; either way the children of a node are contiguous. BreadthFirst keeps the top levels
+// every prediction walks through together. HotPath places the blocks of children depth first, each first child's block
+// right after its parent's, so following first children down from any node walks one run of memory; after
+// reorder_by_traffic those are the hottest paths.
+enum class PackedLayout
+{
+    BreadthFirst,
+    HotPath,
+};
+
+// A trained tree packed into one 64-bit word per node, for prediction only:
+//   bits  0-1   kind (leaf, categorical split or threshold split)
+//   bits  2-9   split attribute
+//   bits 10-17  the parent's attribute value that selects this node, when the parent is a categorical split
+//   bits 18-33  leaf label, or the index of a threshold split's threshold in the side table
+//   bits 34-41  number of children
+//   bits 42-63  distance from this node to its first child
+// Construction throws std::invalid_argument for a tree that does not fit these fields.
+class PackedTree
+{
+    static constexpr unsigned kind_shift = 0, attr_shift = 2, value_shift = 10, label_shift = 18, count_shift = 34, offset_shift = 42;
+    static constexpr uint64_t attr_max = 0xFF, value_max = 0xFF, label_max = 0xFFFF, count_max = 0xFF, offset_max = (uint64_t{1} << 22) - 1;
+
+    enum Kind : uint64_t
+    {
+        Leaf = 0,
+        Inter = 1,
+        Threshold = 2,
+    };
+
+    std::vector<uint64_t> m_nodes;
+    std::vector<int> m_thresholds;
+
+    static uint64_t field(uint64_t word, unsigned shift, uint64_t max) { return (word >> shift) & max; }
+
+    static uint64_t checked(long value, uint64_t max, const char *what)
+    {
+        if (value < 0 || static_cast<uint64_t>(value) > max)
+        {
+            throw std::invalid_argument(std::string(what) + " " + std::to_string(value) + " does not fit a packed tree");
+        }
+        return static_cast<uint64_t>(value);
+    }
+
+    // The child for the smallest value, as in fallback_child.
+    size_t fallback(size_t first, size_t nchildren) const
+    {
+        size_t best = first;
+        for (size_t c = first + 1; c < first + nchildren; ++c)
+        {
+            if (field(m_nodes[c], value_shift, value_max) < field(m_nodes[best], value_shift, value_max))
+            {
+                best = c;
+            }
+        }
+        return best;
+    }
+
+  public:
+    explicit PackedTree(const Node &root, PackedLayout layout = PackedLayout::BreadthFirst)
+    {
+        // Each node's children are placed as one block starting at first[i].
+        std::vector<const Node *> order{&root};
+        std::vector<size_t> first(1, 0);
+        const auto place_children = [&](size_t i)
+        {
+            first[i] = order.size();
+            for (const auto &child : order[i]->children())
+            {
+                order.push_back(&child);
+                first.push_back(0);
+            }
+        };
+        if (layout == PackedLayout::BreadthFirst)
+        {
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                place_children(i);
+            }
+        }
+        else
+        {
+            std::vector<size_t> pending{0};
+            while (!pending.empty())
+            {
+                const size_t i = pending.back();
+                pending.pop_back();
+                place_children(i);
+                for (size_t c = order.size(); c-- > first[i];)
+                {
+                    pending.push_back(c);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const Node &node = *order[i];
+            const size_t first_child = first[i];
+
+            uint64_t word = 0;
+            if (node.is_leaf())
+            {
+                word = Leaf | checked(node.leaf_label(), label_max, "label") << label_shift;
+            }
+            else
+            {
+                word = (node.is_threshold() ? Threshold : Inter) | checked(node.split_attribute(), attr_max, "attribute") << attr_shift |
+                       checked(static_cast<long>(node.children().size()), count_max, "child count") << count_shift |
+                       checked(static_cast<long>(first_child - i), offset_max, "child offset") << offset_shift;
+                if (node.is_threshold())
+                {
+                    word |= checked(static_cast<long>(m_thresholds.size()), label_max, "threshold count") << label_shift;
+                    m_thresholds.push_back(node.threshold());
+                }
+                for (const auto &child : node.children())
+                {
+                    if (!node.is_threshold())
+                    {
+                        checked(child.inter_label(), value_max, "attribute value");
+                    }
+                }
+            }
+
+            // Only read below categorical splits, where it was checked above.
+            if (i > 0 && node.inter_label() >= 0 && static_cast<uint64_t>(node.inter_label()) <= value_max)
+            {
+                word |= static_cast<uint64_t>(node.inter_label()) << value_shift;
+            }
+            m_nodes.push_back(word);
+        }
+    }
+
+    size_t num_nodes() const { return m_nodes.size(); }
+
+    size_t size_bytes() const { return m_nodes.size() * sizeof(uint64_t) + m_thresholds.size() * sizeof(int); }
+
+    // Same answer as tree_predict on the tree this was packed from.
+    int predict(std::span<const int> obs) const
+    {
+        size_t i = 0;
+        while (true)
+        {
+            const uint64_t word = m_nodes[i];
+            const auto kind = field(word, kind_shift, 3);
+            if (kind == Leaf)
+            {
+                return static_cast<int>(field(word, label_shift, label_max));
+            }
+
+            const int value = obs[field(word, attr_shift, attr_max)];
+            const size_t first = i + field(word, offset_shift, offset_max);
+            if (kind == Threshold)
+            {
+                i = first + (value > m_thresholds[field(word, label_shift, label_max)]);
+                continue;
+            }
+
+            const size_t nchildren = field(word, count_shift, count_max);
+            i = first + nchildren;
+            for (size_t c = first; c < first + nchildren; ++c)
+            {
+                if (static_cast<int>(field(m_nodes[c], value_shift, value_max)) == value)
+                {
+                    i = c;
+                    break;
+                }
+            }
+            if (i == first + nchildren) [[unlikely]]
+            {
+                i = fallback(first, nchildren);
+            }
+        }
+    }
+};
+
+inline int tree_predict(std::span<const int> obs, const PackedTree &tree)
+{
+    return tree.predict(obs);
+}
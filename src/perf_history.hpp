@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/core.h>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark history and regression checks for tree_benchmark. Every repetition of every benchmark is kept as one
+// sample, so a comparison works on the raw measurements of both runs rather than on summaries of them.
+//
+// History file: one tab-separated line per sample, appended run after run:
+//   label  benchmark  real_ns  cpu_ns
+// where the label names the build the run measured, normally its commit.
+struct PerfSample
+{
+    std::string label;
+    std::string benchmark;
+    double real_ns;
+    double cpu_ns;
+};
+
+inline void append_history(const std::string &path, std::span<const PerfSample> samples)
+{
+    std::ofstream out(path, std::ios::app);
+    if (!out)
+    {
+        throw std::runtime_error("cannot open " + path + " for writing");
+    }
+    for (const auto &s : samples)
+    {
+        out << s.label << '\t' << s.benchmark << '\t' << fmt::format("{:.1f}\t{:.1f}", s.real_ns, s.cpu_ns) << '\n';
+    }
+    if (!out.flush())
+    {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+// A missing file is an empty history.
+inline std::vector<PerfSample> read_history(const std::string &path)
+{
+    std::vector<PerfSample> samples;
+    std::ifstream in(path);
+    std::string line;
+    for (size_t line_no = 1; std::getline(in, line); ++line_no)
+    {
+        if (line.empty())
+            continue;
+
+        std::istringstream fields(line);
+        PerfSample s;
+        if (!std::getline(fields, s.label, '\t') || !std::getline(fields, s.benchmark, '\t') || !(fields >> s.real_ns >> s.cpu_ns))
+        {
+            throw std::runtime_error(fmt::format("malformed line {} in {}", line_no, path));
+        }
+        samples.push_back(std::move(s));
+    }
+    return samples;
+}
+
+// The most recent label in `history` other than `current`, or an empty string if there is none.
+inline std::string previous_label(std::span<const PerfSample> history, const std::string &current)
+{
+    for (auto it = history.rbegin(); it != history.rend(); ++it)
+    {
+        if (it->label != current)
+            return it->label;
+    }
+    return {};
+}
+
+// Regularized incomplete beta function I_x(a, b), by its continued fraction.
+inline double incomplete_beta(double x, double a, double b)
+{
+    if (x <= 0)
+        return 0;
+    if (x >= 1)
+        return 1;
+
+    // The continued fraction converges quickly only below the mean; above it, use the symmetry.
+    if (x > (a + 1) / (a + b + 2))
+        return 1 - incomplete_beta(1 - x, b, a);
+
+    const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x)) / a;
+    constexpr double tiny = 1e-300;
+    double c = 1;
+    double d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (std::abs(d) < tiny ? tiny : d);
+    double f = d;
+    for (int m = 1; m <= 300; ++m)
+    {
+        for (const bool odd : {false, true})
+        {
+            const double numerator = odd ? -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))
+                                         : m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+            d = 1 + numerator * d;
+            d = 1 / (std::abs(d) < tiny ? tiny : d);
+            c = 1 + numerator / c;
+            c = std::abs(c) < tiny ? tiny : c;
+            f *= c * d;
+            if (odd && std::abs(c * d - 1) < 1e-12)
+                return front * f;
+        }
+    }
+    return front * f;
+}
+
+// Probability that a Student t variable with `dof` degrees of freedom is at least |t| away from zero.
+inline double student_t_two_sided(double t, double dof) { return incomplete_beta(dof / (dof + t * t), dof / 2, 0.5); }
+
+// The t with student_t_two_sided(t, dof) == p.
+inline double student_t_critical(double p, double dof)
+{
+    double lo = 0;
+    double hi = 1e6;
+    for (int i = 0; i < 200; ++i)
+    {
+        const double mid = (lo + hi) / 2;
+        (student_t_two_sided(mid, dof) > p ? lo : hi) = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+struct PerfSummary
+{
+    size_t n = 0;
+    double mean = 0;
+    double stddev = 0;
+    // Half-width of the 95% confidence interval of the mean; zero with fewer than two samples.
+    double ci95 = 0;
+};
+
+inline PerfSummary summarize(std::span<const double> values)
+{
+    PerfSummary s;
+    s.n = values.size();
+    if (s.n == 0)
+        return s;
+
+    for (const double v : values)
+    {
+        s.mean += v;
+    }
+    s.mean /= static_cast<double>(s.n);
+    if (s.n < 2)
+        return s;
+
+    double sq = 0;
+    for (const double v : values)
+    {
+        sq += (v - s.mean) * (v - s.mean);
+    }
+    s.stddev = std::sqrt(sq / static_cast<double>(s.n - 1));
+    const auto dof = static_cast<double>(s.n - 1);
+    s.ci95 = student_t_critical(0.05, dof) * s.stddev / std::sqrt(static_cast<double>(s.n));
+    return s;
+}
+
+// Two-sided p-value of Welch's t-test that the two samples have the same mean; NaN with fewer than two samples on
+// either side.
+inline double welch_p_value(const PerfSummary &a, const PerfSummary &b)
+{
+    if (a.n < 2 || b.n < 2)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    const double va = a.stddev * a.stddev / static_cast<double>(a.n);
+    const double vb = b.stddev * b.stddev / static_cast<double>(b.n);
+    if (va + vb == 0)
+        return a.mean == b.mean ? 1 : 0;
+
+    const double t = (b.mean - a.mean) / std::sqrt(va + vb);
+    const double dof = (va + vb) * (va + vb) / (va * va / static_cast<double>(a.n - 1) + vb * vb / static_cast<double>(b.n - 1));
+    return student_t_two_sided(t, dof);
+}
+
+enum class PerfVerdict
+{
+    Same,
+    Faster,
+    Slower,
+};
+
+struct PerfComparison
+{
+    std::string benchmark;
+    PerfSummary baseline;
+    PerfSummary current;
+    // Relative change of the mean real time, positive when slower.
+    double change = 0;
+    double p_value = 0;
+    PerfVerdict verdict = PerfVerdict::Same;
+};
+
+struct CompareOptions
+{
+    // Significance level of the test.
+    double alpha = 0.05;
+    // Smaller changes are reported as the same even when significant; with enough repetitions every change is.
+    double min_change = 0.02;
+};
+
+// Compares the real times of every benchmark `current` has, in the order it first appears there, with the same
+// benchmark in `baseline`. Benchmarks the baseline lacks are left out.
+inline std::vector<PerfComparison> compare_runs(std::span<const PerfSample> baseline, std::span<const PerfSample> current, const CompareOptions &options = {})
+{
+    const auto group = [](std::span<const PerfSample> samples, std::vector<std::string> *order)
+    {
+        std::map<std::string, std::vector<double>> times;
+        for (const auto &s : samples)
+        {
+            auto [it, inserted] = times.try_emplace(s.benchmark);
+            if (inserted && order)
+                order->push_back(s.benchmark);
+            it->second.push_back(s.real_ns);
+        }
+        return times;
+    };
+    std::vector<std::string> order;
+    const auto current_times = group(current, &order);
+    const auto baseline_times = group(baseline, nullptr);
+
+    std::vector<PerfComparison> comparisons;
+    for (const auto &name : order)
+    {
+        const auto base = baseline_times.find(name);
+        if (base == baseline_times.end())
+            continue;
+
+        PerfComparison c{name, summarize(base->second), summarize(current_times.at(name))};
+        c.change = c.baseline.mean > 0 ? c.current.mean / c.baseline.mean - 1 : 0;
+        c.p_value = welch_p_value(c.baseline, c.current);
+        if (c.p_value < options.alpha && std::abs(c.change) >= options.min_change)
+        {
+            c.verdict = c.change > 0 ? PerfVerdict::Slower : PerfVerdict::Faster;
+        }
+        comparisons.push_back(std::move(c));
+    }
+    return comparisons;
+}
+
+inline std::string format_duration(double ns)
+{
+    if (ns >= 1e9)
+        return fmt::format("{:.3g} s", ns / 1e9);
+    if (ns >= 1e6)
+        return fmt::format("{:.3g} ms", ns / 1e6);
+    if (ns >= 1e3)
+        return fmt::format("{:.3g} us", ns / 1e3);
+    return fmt::format("{:.3g} ns", ns);
+}
+
+// Markdown table of `comparisons`, each time its mean real time and the 95% confidence interval around it.
+inline void print_comparison(std::ostream &out, std::span<const PerfComparison> comparisons, const std::string &baseline_label,
+                             const std::string &current_label)
+{
+    const auto cell = [](const PerfSummary &s) { return fmt::format("{} ± {:.1f}% (n={})", format_duration(s.mean), s.mean > 0 ? 100 * s.ci95 / s.mean : 0, s.n); };
+
+    out << fmt::format("| Benchmark | {} | {} | Change | p | Verdict |\n", baseline_label, current_label);
+    out << "|---|---|---|---|---|---|\n";
+    for (const auto &c : comparisons)
+    {
+        const char *verdict = c.verdict == PerfVerdict::Slower ? "**slower**" : c.verdict == PerfVerdict::Faster ? "faster" : "same";
+        const auto p = std::isnan(c.p_value) ? std::string("n/a") : fmt::format("{:.3f}", c.p_value);
+        out << fmt::format("| {} | {} | {} | {:+.1f}% | {} | {} |\n", c.benchmark, cell(c.baseline), cell(c.current), 100 * c.change, p, verdict);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "dataset.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+struct PruneReport
+{
+    size_t nodes_before = 0;
+    size_t nodes_after = 0;
+    size_t depth_before = 0;
+    size_t depth_after = 0;
+};
+
+// Index of the child that `row` of `ctx` is routed to by tree_predict.
+inline size_t route_child(const Node &node, const TrainingContext &ctx, int row)
+{
+    const int value = ctx.value(static_cast<size_t>(node.split_attribute()), row);
+    if (node.is_threshold())
+    {
+        return value > node.threshold() ? 1 : 0;
+    }
+
+    const auto &children = node.children();
+    const auto child = std::ranges::find_if(children, [value](const Node &n) { return n.inter_label() == value; });
+    return static_cast<size_t>((child == children.end() ? &fallback_child(node) : &*child) - children.data());
+}
+
+// Bottom-up reduced-error pruning: a subtree becomes a leaf whenever that does not increase its errors on the held-out
+// `rows`, which are reordered to follow the tree. Returns the errors of what is left of the subtree.
+inline int reduced_error_prune(Node &node, const TrainingContext &ctx, std::span<int> rows)
+{
+    int leaf_errors = 0;
+    for (int row : rows)
+    {
+        leaf_errors += ctx.target(row) != node.stats().mode_label;
+    }
+
+    if (node.is_leaf())
+    {
+        return leaf_errors;
+    }
+
+    int subtree_errors = 0;
+    auto rest = rows;
+    for (size_t i = 0; i < node.children().size(); ++i)
+    {
+        const auto mid = std::partition(rest.begin(), rest.end(), [&](int row) { return route_child(node, ctx, row) == i; });
+        const auto n = static_cast<size_t>(mid - rest.begin());
+        subtree_errors += reduced_error_prune(node.children()[i], ctx, rest.first(n));
+        rest = rest.subspan(n);
+    }
+
+    if (leaf_errors <= subtree_errors)
+    {
+        node.collapse();
+        return leaf_errors;
+    }
+    return subtree_errors;
+}
+
+// Prunes `tree` against the rows of `ctx` listed in `holdout`, which should not have been selected for training.
+inline PruneReport prune_reduced_error(Node &tree, const TrainingContext &ctx, std::span<const int> holdout)
+{
+    PruneReport report{.nodes_before = count_nodes(tree), .depth_before = tree_depth(tree)};
+
+    std::vector<int> rows(holdout.begin(), holdout.end());
+    reduced_error_prune(tree, ctx, rows);
+
+    report.nodes_after = count_nodes(tree);
+    report.depth_after = tree_depth(tree);
+    return report;
+}
+
+// Minimal cost-complexity pruning for a fixed `alpha`: keeps a subtree only if its training error rate plus `alpha` per
+// leaf is strictly lower than that of collapsing it. Error rates are relative to `total` training rows. Returns the cost
+// of what is left of the subtree.
+inline double cost_complexity_prune(Node &node, double alpha, double total)
+{
+    const double leaf_cost = node.stats().errors() / total + alpha;
+    if (node.is_leaf())
+    {
+        return leaf_cost;
+    }
+
+    double subtree_cost = 0;
+    for (auto &child : node.children())
+    {
+        subtree_cost += cost_complexity_prune(child, alpha, total);
+    }
+
+    if (leaf_cost <= subtree_cost)
+    {
+        node.collapse();
+        return leaf_cost;
+    }
+    return subtree_cost;
+}
+
+// Larger `alpha` gives smaller trees: 0 only removes splits that do not reduce training error, while anything above the
+// root's training error rate leaves a single leaf.
+inline PruneReport prune_cost_complexity(Node &tree, double alpha)
+{
+    PruneReport report{.nodes_before = count_nodes(tree), .depth_before = tree_depth(tree)};
+
+    cost_complexity_prune(tree, alpha, std::max(tree.stats().num_samples, 1));
+
+    report.nodes_after = count_nodes(tree);
+    report.depth_after = tree_depth(tree);
+    return report;
+}
@@ -0,0 +1,85 @@
+#include "bulk_score.hpp"
+#include "serialize.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+static void usage()
+{
+    fmt::print(stderr, "usage: tree_score [--binary WIDTH] [--skip-header] [--threads N] [--chunk-kb N] MODEL INPUT [OUTPUT]\n"
+                       "Writes the label MODEL predicts for every row of INPUT, one per line and in input order, to OUTPUT or stdout.\n"
+                       "INPUT is csv unless --binary gives the number of i32 values per row.\n");
+    std::exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    BulkScoreOptions options;
+    size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const auto value = [&]
+        {
+            if (i + 1 >= argc)
+                usage();
+            return std::string(argv[++i]);
+        };
+
+        if (arg == "--binary")
+        {
+            options.format = InputFormat::Binary;
+            options.width = std::stoul(value());
+        }
+        else if (arg == "--skip-header")
+            options.skip_header = true;
+        else if (arg == "--threads")
+            threads = std::max<size_t>(std::stoul(value()), 1);
+        else if (arg == "--chunk-kb")
+            options.chunk_bytes = std::stoul(value()) << 10;
+        else if (arg.starts_with("--"))
+            usage();
+        else
+            paths.emplace_back(arg);
+    }
+
+    if (paths.size() < 2 || paths.size() > 3)
+        usage();
+
+    try
+    {
+        const auto tree = load_tree(paths[0]);
+        const MappedFile input(paths[1]);
+
+        std::ofstream file;
+        if (paths.size() == 3)
+        {
+            file.open(paths[2], std::ios::binary);
+            if (!file)
+                throw std::runtime_error("cannot open " + paths[2] + " for writing");
+        }
+        std::ostream &out = paths.size() == 3 ? file : std::cout;
+        std::ios::sync_with_stdio(false);
+
+        ThreadPool pool(threads);
+        const auto start = std::chrono::steady_clock::now();
+        const auto rows = bulk_score(input.view(), tree, out, pool, options);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!out)
+            throw std::runtime_error("error writing predictions");
+        fmt::print(stderr, "scored {} rows in {:.3f}s ({:.0f} rows/s)\n", rows, elapsed.count(), static_cast<double>(rows) / elapsed.count());
+    }
+    catch (const std::exception &e)
+    {
+        fmt::print(stderr, "tree_score: {}\n", e.what());
+        return 1;
+    }
+}
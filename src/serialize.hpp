@@ -0,0 +1,149 @@
+#pragma once
+
+#include "node.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Binary model format: the magic and version, then every node in preorder as a kind byte followed by fixed-width
+// fields in host byte order. Models are meant to be written and read on the same kind of machine.
+inline constexpr std::array<char, 4> tree_file_magic = {'I', 'D', '3', 'T'};
+inline constexpr uint32_t tree_file_version = 1;
+
+enum class NodeKind : uint8_t
+{
+    Leaf = 0,
+    Inter = 1,
+    Threshold = 2,
+};
+
+template <typename T>
+inline void write_pod(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+inline T read_pod(std::istream &in)
+{
+    T value{};
+    if (!in.read(reinterpret_cast<char *>(&value), sizeof(T)))
+    {
+        throw std::runtime_error("truncated tree file");
+    }
+    return value;
+}
+
+inline void write_tree_node(std::ostream &out, const Node &node)
+{
+    const auto kind = node.is_leaf() ? NodeKind::Leaf : node.is_threshold() ? NodeKind::Threshold : NodeKind::Inter;
+    write_pod(out, kind);
+    write_pod(out, static_cast<int32_t>(node.is_leaf() ? node.leaf_label() : node.split_attribute()));
+    write_pod(out, static_cast<int32_t>(node.inter_label()));
+    write_pod(out, static_cast<int32_t>(node.threshold()));
+    write_pod(out, static_cast<int32_t>(node.stats().num_samples));
+    write_pod(out, static_cast<int32_t>(node.stats().mode_count));
+    write_pod(out, static_cast<int32_t>(node.stats().mode_label));
+    write_pod(out, static_cast<uint32_t>(node.children().size()));
+
+    for (const auto &child : node.children())
+    {
+        write_tree_node(out, child);
+    }
+}
+
+inline Node read_tree_node(std::istream &in, int depth)
+{
+    if (depth > 4096)
+    {
+        throw std::runtime_error("tree file nests too deeply");
+    }
+
+    const auto kind = read_pod<NodeKind>(in);
+    const auto label_or_attr = read_pod<int32_t>(in);
+    const auto inter_label = read_pod<int32_t>(in);
+    const auto threshold = read_pod<int32_t>(in);
+    NodeStats stats;
+    stats.num_samples = read_pod<int32_t>(in);
+    stats.mode_count = read_pod<int32_t>(in);
+    stats.mode_label = read_pod<int32_t>(in);
+    const auto nchildren = read_pod<uint32_t>(in);
+
+    std::vector<Node> children;
+    for (uint32_t i = 0; i < nchildren; ++i)
+    {
+        children.push_back(read_tree_node(in, depth + 1));
+    }
+
+    Node node = Node::make_leaf(label_or_attr);
+    switch (kind)
+    {
+    case NodeKind::Leaf:
+        if (!children.empty())
+            throw std::runtime_error("leaf with children in tree file");
+        break;
+    case NodeKind::Inter:
+        if (children.empty())
+            throw std::runtime_error("split without children in tree file");
+        node = Node::make_inter(label_or_attr, std::move(children));
+        break;
+    case NodeKind::Threshold:
+        if (children.size() != 2)
+            throw std::runtime_error("threshold split without two children in tree file");
+        node = Node::make_threshold(label_or_attr, threshold, std::move(children[0]), std::move(children[1]));
+        break;
+    default:
+        throw std::runtime_error("unknown node kind in tree file");
+    }
+
+    node.set_inter_label(inter_label);
+    node.set_stats(stats);
+    return node;
+}
+
+inline void save_tree(const Node &tree, std::ostream &out)
+{
+    out.write(tree_file_magic.data(), tree_file_magic.size());
+    write_pod(out, tree_file_version);
+    write_tree_node(out, tree);
+}
+
+inline Node load_tree(std::istream &in)
+{
+    std::array<char, 4> magic{};
+    if (!in.read(magic.data(), magic.size()) || magic != tree_file_magic)
+    {
+        throw std::runtime_error("not a tree file");
+    }
+    if (read_pod<uint32_t>(in) != tree_file_version)
+    {
+        throw std::runtime_error("unsupported tree file version");
+    }
+    return read_tree_node(in, 0);
+}
+
+inline void save_tree(const Node &tree, const std::string &path)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        throw std::runtime_error("cannot open " + path + " for writing");
+    }
+    save_tree(tree, out);
+}
+
+inline Node load_tree(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+    return load_tree(in);
+}
@@ -0,0 +1,201 @@
+#include "serialize.hpp"
+#include "serve.hpp"
+
+#include <csignal>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <poll.h>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <sys/un.h>
+
+static volatile std::sig_atomic_t g_stop = 0;
+static volatile std::sig_atomic_t g_reload = 0;
+
+static void usage()
+{
+    fmt::print(stderr, "usage: tree_serve [--socket PATH] [--threads N] [--max-batch N] [--budget-us N] [--stats-interval SECONDS] MODEL...\n"
+                       "Serves MODEL files written by save_tree, reading requests from stdin and answering on stdout unless --socket is given.\n"
+                       "SIGHUP reloads the MODEL files without interrupting requests.\n");
+    std::exit(2);
+}
+
+static void print_stats(const PredictionServer &server)
+{
+    const auto s = server.stats();
+    fmt::print(stderr, "requests={} batches={} mean_batch={:.1f} p50={:.1f}us p99={:.1f}us throughput={:.0f}/s\n", s.requests, s.batches, s.mean_batch_size,
+               static_cast<double>(s.p50.count()) / 1e3, static_cast<double>(s.p99.count()) / 1e3, s.requests_per_second);
+}
+
+static void reload_models(PredictionServer &server, const std::vector<std::string> &paths)
+{
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        try
+        {
+            server.publish_model(i, load_tree(paths[i]));
+        }
+        catch (const std::exception &e)
+        {
+            fmt::print(stderr, "keeping previous model {}: {}\n", paths[i], e.what());
+        }
+    }
+    fmt::print(stderr, "reloaded {} models\n", paths.size());
+}
+
+static int listen_unix(const std::string &path)
+{
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || path.size() >= sizeof(addr.sun_path))
+    {
+        fmt::print(stderr, "cannot create socket {}\n", path);
+        std::exit(1);
+    }
+    path.copy(addr.sun_path, path.size());
+
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(fd, 64) != 0)
+    {
+        fmt::print(stderr, "cannot listen on {}\n", path);
+        std::exit(1);
+    }
+    return fd;
+}
+
+static void serve_socket(PredictionServer &server, const std::string &path)
+{
+    const int listen_fd = listen_unix(path);
+
+    std::mutex conns_mutex;
+    std::condition_variable conns_cv;
+    std::set<int> conns;
+
+    while (!g_stop)
+    {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0)
+            continue;
+
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+
+        {
+            std::lock_guard lock(conns_mutex);
+            conns.insert(fd);
+        }
+        std::thread(
+            [&, fd]
+            {
+                server.serve(fd, fd);
+                std::lock_guard lock(conns_mutex);
+                conns.erase(fd);
+                ::close(fd);
+                conns_cv.notify_all();
+            })
+            .detach();
+    }
+
+    // Stop reading from the clients, but answer what they have already sent.
+    std::unique_lock lock(conns_mutex);
+    for (int fd : conns)
+    {
+        ::shutdown(fd, SHUT_RD);
+    }
+    conns_cv.wait(lock, [&] { return conns.empty(); });
+
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    ServerOptions options;
+    std::string socket_path;
+    int stats_interval = 10;
+    std::vector<std::string> model_paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const auto value = [&]
+        {
+            if (i + 1 >= argc)
+                usage();
+            return std::string(argv[++i]);
+        };
+
+        if (arg == "--socket")
+            socket_path = value();
+        else if (arg == "--threads")
+            options.threads = std::stoul(value());
+        else if (arg == "--max-batch")
+            options.max_batch = std::stoul(value());
+        else if (arg == "--budget-us")
+            options.latency_budget = std::chrono::microseconds(std::stol(value()));
+        else if (arg == "--stats-interval")
+            stats_interval = std::stoi(value());
+        else if (arg.starts_with("--"))
+            usage();
+        else
+            model_paths.emplace_back(arg);
+    }
+
+    if (model_paths.empty())
+        usage();
+
+    std::vector<Node> models;
+    for (const auto &path : model_paths)
+    {
+        models.push_back(load_tree(path));
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, [](int) { g_stop = 1; });
+    std::signal(SIGTERM, [](int) { g_stop = 1; });
+    std::signal(SIGHUP, [](int) { g_reload = 1; });
+
+    PredictionServer server(std::move(models), options);
+
+    std::jthread reporter(
+        [&](std::stop_token stop)
+        {
+            std::mutex mutex;
+            std::condition_variable_any cv;
+            std::unique_lock lock(mutex);
+            auto next_stats = std::chrono::steady_clock::now() + std::chrono::seconds(stats_interval);
+            while (true)
+            {
+                cv.wait_for(lock, stop, std::chrono::milliseconds(200), [] { return false; });
+                if (stop.stop_requested())
+                    break;
+                if (g_reload)
+                {
+                    g_reload = 0;
+                    reload_models(server, model_paths);
+                }
+                if (stats_interval > 0 && std::chrono::steady_clock::now() >= next_stats)
+                {
+                    print_stats(server);
+                    next_stats += std::chrono::seconds(stats_interval);
+                }
+            }
+        });
+
+    if (socket_path.empty())
+    {
+        server.serve(STDIN_FILENO, STDOUT_FILENO);
+    }
+    else
+    {
+        serve_socket(server, socket_path);
+    }
+
+    reporter.request_stop();
+    reporter.join();
+    print_stats(server);
+}
@@ -0,0 +1,378 @@
+#pragma once
+
+#include "fd_io.hpp"
+#include "model_handle.hpp"
+#include "node.hpp"
+#include "packed_tree.hpp"
+#include "thread_pool.hpp"
+#include "tree.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Wire format of the prediction server, in host byte order:
+//   request:  u32 id, u16 model index, u16 value count, then that many i32 observation values
+//   response: u32 id, i32 predicted label, or a negative PredictError
+// Responses to one stream may come back in a different order than the requests; clients match them up by id.
+struct RequestHeader
+{
+    uint32_t id;
+    uint16_t model;
+    uint16_t num_values;
+};
+
+struct Response
+{
+    uint32_t id;
+    int32_t label;
+};
+
+static_assert(sizeof(RequestHeader) == 8 && sizeof(Response) == 8);
+
+enum PredictError : int32_t
+{
+    UnknownModel = -1,
+    ShortObservation = -2,
+};
+
+// Lock-free latency histogram. Each power of two of nanoseconds is split into 8 linear buckets, so a reported
+// percentile overestimates the true value by at most 12.5%.
+class LatencyHistogram
+{
+    static constexpr unsigned sub_bits = 3;
+    static constexpr size_t num_buckets = 64 << sub_bits;
+
+    std::array<std::atomic<uint64_t>, num_buckets> m_counts{};
+
+    static size_t bucket(uint64_t ns)
+    {
+        if (ns < (1U << sub_bits))
+            return ns;
+
+        const auto msb = static_cast<unsigned>(std::bit_width(ns)) - 1;
+        const auto sub = (ns >> (msb - sub_bits)) & ((1U << sub_bits) - 1);
+        return ((msb - sub_bits + 1) << sub_bits) + sub;
+    }
+
+    static uint64_t bucket_upper(size_t idx)
+    {
+        if (idx < (1U << sub_bits))
+            return idx;
+
+        const auto msb = (idx >> sub_bits) + sub_bits - 1;
+        const auto sub = idx & ((1U << sub_bits) - 1);
+        const auto width = uint64_t{1} << (msb - sub_bits);
+        return (((1U << sub_bits) + sub) << (msb - sub_bits)) + width - 1;
+    }
+
+  public:
+    void record(std::chrono::nanoseconds latency)
+    {
+        const auto ns = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+        m_counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const
+    {
+        uint64_t total = 0;
+        for (const auto &c : m_counts)
+        {
+            total += c.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::chrono::nanoseconds percentile(double p) const
+    {
+        const auto total = count();
+        if (total == 0)
+            return {};
+
+        const auto rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < num_buckets; ++i)
+        {
+            seen += m_counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::chrono::nanoseconds(bucket_upper(i));
+        }
+        return std::chrono::nanoseconds(bucket_upper(num_buckets - 1));
+    }
+};
+
+struct ServerOptions
+{
+    size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    size_t max_batch = 64;
+    std::chrono::microseconds latency_budget{200};
+};
+
+struct ServerStats
+{
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    double mean_batch_size = 0;
+    std::chrono::nanoseconds p50{};
+    std::chrono::nanoseconds p99{};
+    double requests_per_second = 0;
+};
+
+// The models a server answers from. Swapping one model shares the others with the previous set. Models that fit a
+// PackedTree are answered from it, so many of them stay cache resident at once.
+struct ModelSet
+{
+    std::vector<std::shared_ptr<const Node>> trees;
+    std::vector<std::shared_ptr<const PackedTree>> packed;
+    std::vector<size_t> widths;
+};
+
+// Scores framed observations against a set of models that can be replaced while serving. Requests from every stream go through one queue that is
+// cut into micro-batches: while a worker is idle a batch is dispatched straight away, and while all of them are busy
+// requests are coalesced until the batch is full or its oldest request has waited for the latency budget.
+class PredictionServer
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection
+    {
+        int out_fd;
+        std::mutex write_mutex;
+        std::atomic<size_t> pending{0};
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+
+        explicit Connection(int fd) : out_fd(fd) {}
+    };
+
+    struct Request
+    {
+        std::shared_ptr<Connection> conn;
+        RequestHeader header;
+        std::vector<int> values;
+        Clock::time_point arrival;
+    };
+
+    ServerOptions m_options;
+    ModelHandle<ModelSet> m_models;
+    std::mutex m_swap_mutex;
+    ModelSet m_published;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Request> m_queue;
+    size_t m_busy = 0;
+    bool m_stop = false;
+
+    LatencyHistogram m_latency;
+    std::atomic<uint64_t> m_requests{0};
+    std::atomic<uint64_t> m_batches{0};
+    Clock::time_point m_start = Clock::now();
+
+    ThreadPool m_pool;
+    std::thread m_batcher;
+
+  public:
+    PredictionServer(std::vector<Node> models, ServerOptions options)
+        : m_options(options), m_models(make_model_set(std::move(models)), std::max<size_t>(options.threads, 1)),
+          m_pool(std::max<size_t>(options.threads, 1))
+    {
+        m_options.max_batch = std::max<size_t>(m_options.max_batch, 1);
+        m_published = *m_models.reader().pin();
+        m_batcher = std::thread([this] { batch_loop(); });
+    }
+
+    PredictionServer(const PredictionServer &) = delete;
+    PredictionServer &operator=(const PredictionServer &) = delete;
+
+    // Answers everything already received before shutting down.
+    ~PredictionServer()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_batcher.join();
+    }
+
+    // Reads requests from `in_fd` until end of stream and returns once every one of them has been answered on `out_fd`.
+    // Any number of streams can be served concurrently from different threads.
+    void serve(int in_fd, int out_fd)
+    {
+        auto conn = std::make_shared<Connection>(out_fd);
+
+        RequestHeader header{};
+        while (read_full(in_fd, &header, sizeof(header)))
+        {
+            Request req{conn, header, std::vector<int>(header.num_values), {}};
+            if (!read_full(in_fd, req.values.data(), req.values.size() * sizeof(int)))
+                break;
+
+            req.arrival = Clock::now();
+            conn->pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard lock(m_mutex);
+                m_queue.push_back(std::move(req));
+            }
+            m_cv.notify_all();
+        }
+
+        std::unique_lock lock(conn->done_mutex);
+        conn->done_cv.wait(lock, [&] { return conn->pending.load() == 0; });
+    }
+
+    // Replaces model `index`, or adds it if `index` is one past the last model. Batches already running finish on the
+    // models they started with; requests are never held up by a swap.
+    void publish_model(size_t index, Node model)
+    {
+        std::lock_guard lock(m_swap_mutex);
+        if (index > m_published.trees.size())
+        {
+            throw std::out_of_range("model index out of range");
+        }
+        if (index == m_published.trees.size())
+        {
+            m_published.trees.emplace_back();
+            m_published.packed.emplace_back();
+            m_published.widths.emplace_back();
+        }
+        m_published.widths[index] = tree_input_width(model);
+        m_published.packed[index] = try_pack(model);
+        m_published.trees[index] = std::make_shared<const Node>(std::move(model));
+        m_models.publish(std::make_unique<const ModelSet>(m_published));
+    }
+
+    ServerStats stats() const
+    {
+        ServerStats s;
+        s.requests = m_requests.load();
+        s.batches = m_batches.load();
+        s.mean_batch_size = s.batches ? static_cast<double>(s.requests) / static_cast<double>(s.batches) : 0;
+        s.p50 = m_latency.percentile(0.5);
+        s.p99 = m_latency.percentile(0.99);
+        const std::chrono::duration<double> elapsed = Clock::now() - m_start;
+        s.requests_per_second = static_cast<double>(s.requests) / elapsed.count();
+        return s;
+    }
+
+  private:
+    static std::unique_ptr<const ModelSet> make_model_set(std::vector<Node> models)
+    {
+        auto set = std::make_unique<ModelSet>();
+        for (auto &model : models)
+        {
+            set->widths.push_back(tree_input_width(model));
+            set->packed.push_back(try_pack(model));
+            set->trees.push_back(std::make_shared<const Node>(std::move(model)));
+        }
+        return set;
+    }
+
+    static std::shared_ptr<const PackedTree> try_pack(const Node &model)
+    {
+        try
+        {
+            return std::make_shared<const PackedTree>(model);
+        }
+        catch (const std::invalid_argument &)
+        {
+            return nullptr;
+        }
+    }
+
+    void batch_loop()
+    {
+        std::unique_lock lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+
+            const auto deadline = m_queue.front().arrival + m_options.latency_budget;
+            m_cv.wait_until(lock, deadline, [this] { return m_stop || m_queue.size() >= m_options.max_batch || m_busy < m_pool.size(); });
+
+            const auto n = std::min(m_queue.size(), m_options.max_batch);
+            auto batch = std::make_shared<std::vector<Request>>(std::make_move_iterator(m_queue.begin()),
+                                                                std::make_move_iterator(m_queue.begin() + static_cast<std::ptrdiff_t>(n)));
+            m_queue.erase(m_queue.begin(), m_queue.begin() + static_cast<std::ptrdiff_t>(n));
+            ++m_busy;
+
+            lock.unlock();
+            m_pool.submit([this, batch] { run_batch(*batch); });
+            lock.lock();
+        }
+    }
+
+    static int32_t predict(const ModelSet &models, const Request &req)
+    {
+        if (req.header.model >= models.trees.size())
+            return UnknownModel;
+        if (req.values.size() < models.widths[req.header.model])
+            return ShortObservation;
+
+        if (const auto &packed = models.packed[req.header.model])
+            return packed->predict(req.values);
+        return tree_predict(req.values, *models.trees[req.header.model]);
+    }
+
+    void run_batch(std::vector<Request> &batch)
+    {
+        // At most one batch runs per worker, so there is always a free reader slot.
+        const auto reader = m_models.reader();
+        const auto models = reader.pin();
+
+        std::vector<Response> responses;
+        responses.reserve(batch.size());
+
+        // Requests from one stream tend to sit next to each other, so their responses go out in one write.
+        size_t run_start = 0;
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            responses.push_back({batch[i].header.id, predict(*models, batch[i])});
+
+            if (i + 1 == batch.size() || batch[i + 1].conn != batch[i].conn)
+            {
+                auto &conn = *batch[i].conn;
+                std::lock_guard lock(conn.write_mutex);
+                write_full(conn.out_fd, responses.data() + run_start, (i + 1 - run_start) * sizeof(Response));
+                run_start = i + 1;
+            }
+        }
+
+        const auto now = Clock::now();
+        for (const auto &req : batch)
+        {
+            m_latency.record(now - req.arrival);
+        }
+        m_requests.fetch_add(batch.size());
+        m_batches.fetch_add(1);
+
+        {
+            std::lock_guard lock(m_mutex);
+            --m_busy;
+        }
+        m_cv.notify_all();
+
+        for (auto &req : batch)
+        {
+            auto &conn = *req.conn;
+            if (conn.pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock(conn.done_mutex);
+                conn.done_cv.notify_all();
+            }
+        }
+    }
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "dataset.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// A table encoded once into a file in the layout TrainingContext trains on, so that any number of trainer processes
+// can map it read-only and build on it in place: nothing is parsed, transposed or copied, and every process shares
+// the same pages. A path under /dev/shm keeps the table in shared memory.
+//
+// Layout, in host byte order: a SharedTableHeader, then the label column and every attribute column as num_rows i32
+// values each. Every section starts on a 64-byte boundary.
+inline constexpr std::array<char, 4> shared_table_magic = {'I', 'D', '3', 'D'};
+inline constexpr uint32_t shared_table_version = 1;
+
+struct SharedTableHeader
+{
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint64_t num_rows;
+    uint64_t num_attributes;
+    uint64_t numeric;
+    // The largest categorical value and the largest label, which size a context's count buffers.
+    int32_t max_value;
+    int32_t max_target;
+};
+
+inline constexpr size_t shared_table_align = 64;
+
+inline size_t shared_table_section(size_t num_rows, size_t section)
+{
+    const auto align = [](size_t n) { return (n + shared_table_align - 1) / shared_table_align * shared_table_align; };
+    return align(sizeof(SharedTableHeader)) + section * align(num_rows * sizeof(int32_t));
+}
+
+// Encodes the table into `path`. It is written next to `path` and renamed into place, so a process opening `path` sees
+// either the previous table or the whole new one.
+inline void publish_table(const std::string &path, const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data,
+                          std::bitset<64> numeric = {})
+{
+    if (row_data.size() != target_data.size())
+    {
+        throw std::invalid_argument("one label per row is needed");
+    }
+
+    const size_t num_rows = row_data.size();
+    const size_t ncols = row_data.empty() ? 0 : row_data[0].size();
+    SharedTableHeader header{shared_table_magic, shared_table_version, num_rows, ncols, numeric.to_ullong(), 0, 0};
+    for (const int label : target_data)
+    {
+        header.max_target = std::max(header.max_target, label);
+    }
+    for (const auto &row : row_data)
+    {
+        for (size_t j = 0; j < ncols; ++j)
+        {
+            if (!numeric.test(j))
+                header.max_value = std::max(header.max_value, row[j]);
+        }
+    }
+
+    const auto tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("cannot open " + tmp_path + " for writing");
+        }
+
+        const auto write_section = [&out, num_rows](size_t section, std::span<const int> values)
+        {
+            out.seekp(static_cast<std::streamoff>(shared_table_section(num_rows, section)));
+            out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+        };
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write_section(0, target_data);
+        std::vector<int> col(num_rows);
+        for (size_t j = 0; j < ncols; ++j)
+        {
+            for (size_t i = 0; i < num_rows; ++i)
+            {
+                col[i] = row_data[i][j];
+            }
+            write_section(j + 1, col);
+        }
+
+        // Pads the last section out to its full size.
+        const auto end = shared_table_section(num_rows, ncols + 1);
+        out.seekp(static_cast<std::streamoff>(end - 1));
+        out.put('\0');
+        if (!out.flush())
+        {
+            throw std::runtime_error("cannot write " + tmp_path);
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("cannot publish " + path);
+    }
+}
+
+// A published table mapped read-only. Shared by every context attached to it, which keep the mapping alive.
+class SharedTable
+{
+    const std::byte *m_data = nullptr;
+    size_t m_size = 0;
+    SharedTableHeader m_header{};
+
+  public:
+    explicit SharedTable(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("cannot open " + path);
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        void *data = m_size == 0 ? MAP_FAILED : ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            throw std::runtime_error("not a table file");
+        }
+        m_data = static_cast<const std::byte *>(data);
+
+        try
+        {
+            validate();
+        }
+        catch (...)
+        {
+            ::munmap(const_cast<std::byte *>(m_data), m_size);
+            throw;
+        }
+    }
+
+    SharedTable(const SharedTable &) = delete;
+    SharedTable &operator=(const SharedTable &) = delete;
+
+    ~SharedTable() { ::munmap(const_cast<std::byte *>(m_data), m_size); }
+
+    static std::shared_ptr<const SharedTable> open(const std::string &path) { return std::make_shared<const SharedTable>(path); }
+
+    size_t num_rows() const { return m_header.num_rows; }
+
+    size_t num_attributes() const { return m_header.num_attributes; }
+
+    std::bitset<64> numeric() const { return m_header.numeric; }
+
+    int max_value() const { return m_header.max_value; }
+
+    int max_target() const { return m_header.max_target; }
+
+    std::span<const int> target() const { return section(0); }
+
+    std::span<const int> column(size_t col) const { return section(col + 1); }
+
+  private:
+    std::span<const int> section(size_t index) const
+    {
+        return {reinterpret_cast<const int *>(m_data + shared_table_section(num_rows(), index)), num_rows()};
+    }
+
+    void validate()
+    {
+        if (m_size < sizeof(SharedTableHeader))
+        {
+            throw std::runtime_error("not a table file");
+        }
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        if (m_header.magic != shared_table_magic)
+        {
+            throw std::runtime_error("not a table file");
+        }
+        if (m_header.version != shared_table_version)
+        {
+            throw std::runtime_error("unsupported table file version");
+        }
+        if (m_header.num_attributes > 64 || m_header.max_value < 0 || m_header.max_target < 0 ||
+            m_header.num_rows > (m_size - sizeof(SharedTableHeader)) / sizeof(int32_t) ||
+            m_size != shared_table_section(m_header.num_rows, m_header.num_attributes + 1))
+        {
+            throw std::runtime_error("truncated table file");
+        }
+    }
+};
+
+// Points `ctx` at `table` in place. Weights start at one and every row is selected, as after assign.
+inline void attach(TrainingContext &ctx, std::shared_ptr<const SharedTable> table)
+{
+    std::vector<std::span<const int>> cols(table->num_attributes());
+    for (size_t col = 0; col < cols.size(); ++col)
+    {
+        cols[col] = table->column(col);
+    }
+    const auto target = table->target();
+    const int max_value = table->max_value();
+    const int max_target = table->max_target();
+    const auto numeric = table->numeric();
+    ctx.assign_view(std::move(cols), target, max_value, max_target, numeric, std::move(table));
+}
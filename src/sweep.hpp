@@ -0,0 +1,118 @@
+#pragma once
+
+#include "dataset.hpp"
+#include "node.hpp"
+#include "prune.hpp"
+#include "tree.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+struct SweepConfig
+{
+    int min_samples_split = 2;
+    int max_depth = std::numeric_limits<int>::max();
+};
+
+struct SweepResult
+{
+    SweepConfig config;
+    size_t nodes = 0;
+    // Weighted count of validation rows the config's tree gets wrong.
+    int errors = 0;
+};
+
+struct TreeSweep
+{
+    // The tree for the smallest min_samples_split and largest max_depth swept; truncate_tree turns it into any
+    // config's tree.
+    Node tree;
+    std::vector<SweepResult> results;
+};
+
+// A node stops growing under `config` where id3 would have made it a leaf: it has too few rows or is too deep.
+inline bool stops_at(const Node &node, const SweepConfig &config, int depth)
+{
+    return node.is_leaf() || node.stats().num_samples <= config.min_samples_split || depth >= config.max_depth;
+}
+
+// The tree build_tree would make with `config`, cut from `tree`, which was built with a smaller or equal
+// min_samples_split and a larger or equal max_depth and otherwise the same options. Split choices never depend on
+// either setting, so the larger tree only ever grows further below where the smaller one stops.
+inline Node truncate_tree(Node tree, const SweepConfig &config, int depth = 0)
+{
+    if (stops_at(tree, config, depth))
+    {
+        tree.collapse();
+        return tree;
+    }
+    for (auto &child : tree.children())
+    {
+        child = truncate_tree(std::move(child), config, depth + 1);
+    }
+    return tree;
+}
+
+inline size_t count_truncated_nodes(const Node &node, const SweepConfig &config, int depth = 0)
+{
+    if (stops_at(node, config, depth))
+        return 1;
+
+    size_t nodes = 1;
+    for (const auto &child : node.children())
+    {
+        nodes += count_truncated_nodes(child, config, depth + 1);
+    }
+    return nodes;
+}
+
+// Tunes min_samples_split and max_depth with one build: grows the tree for the loosest of `configs` on the rows
+// selected in `ctx`, then scores every config on the `validation` rows of `ctx` in a single pass, following each row
+// down the tree once and noting where every config would have stopped. `options` supplies everything else.
+template <typename Criterion = Entropy>
+inline TreeSweep sweep_tree(TrainingContext &ctx, std::span<const SweepConfig> configs, std::span<const int> validation, BuildOptions options = {})
+{
+    if (configs.empty())
+    {
+        throw std::invalid_argument("nothing to sweep");
+    }
+
+    options.min_samples_split = std::ranges::min(configs, {}, &SweepConfig::min_samples_split).min_samples_split;
+    options.max_depth = std::ranges::max(configs, {}, &SweepConfig::max_depth).max_depth;
+    TreeSweep sweep{.tree = build_tree<Criterion>(ctx, options), .results = {}};
+
+    for (const auto &config : configs)
+    {
+        sweep.results.push_back({.config = config, .nodes = count_truncated_nodes(sweep.tree, config), .errors = 0});
+    }
+
+    std::vector<bool> stopped(configs.size());
+    for (const int row : validation)
+    {
+        std::fill(stopped.begin(), stopped.end(), false);
+        size_t remaining = configs.size();
+        const Node *node = &sweep.tree;
+        for (int depth = 0; remaining > 0; ++depth)
+        {
+            const int label = node->is_leaf() ? node->leaf_label() : node->stats().mode_label;
+            for (size_t c = 0; c < configs.size(); ++c)
+            {
+                if (!stopped[c] && stops_at(*node, configs[c], depth))
+                {
+                    stopped[c] = true;
+                    --remaining;
+                    sweep.results[c].errors += label != ctx.target(row) ? ctx.weight(row) : 0;
+                }
+            }
+            if (node->is_leaf())
+                break;
+
+            node = &node->children()[route_child(*node, ctx, row)];
+        }
+    }
+
+    return sweep;
+}
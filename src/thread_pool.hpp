@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads draining a FIFO of tasks. Destruction finishes the queued tasks before joining.
+class ThreadPool
+{
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+
+  public:
+    explicit ThreadPool(size_t nthreads = std::max(1U, std::thread::hardware_concurrency()))
+    {
+        m_threads.reserve(nthreads);
+        for (size_t i = 0; i < nthreads; ++i)
+        {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto &t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    size_t size() const { return m_threads.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+  private:
+    void run()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+// Runs `body(begin, end)` over [0, n) cut into one contiguous range per worker, every boundary but the last a multiple
+// of `grain`. The calling thread takes the first range itself and returns once all of them are done. `body` must not
+// throw.
+template <typename F>
+inline void parallel_for(ThreadPool &pool, size_t n, size_t grain, F &&body)
+{
+    grain = std::max<size_t>(grain, 1);
+    const size_t grains = (n + grain - 1) / grain;
+    const size_t shards = std::min(pool.size(), grains);
+    if (shards <= 1)
+    {
+        if (n > 0)
+            body(size_t{0}, n);
+        return;
+    }
+
+    const size_t per_shard = (grains + shards - 1) / shards * grain;
+    const size_t num_shards = (n + per_shard - 1) / per_shard;
+    std::latch done(static_cast<std::ptrdiff_t>(num_shards - 1));
+    for (size_t s = 1; s < num_shards; ++s)
+    {
+        pool.submit(
+            [&, s]
+            {
+                body(s * per_shard, std::min(n, (s + 1) * per_shard));
+                done.count_down();
+            });
+    }
+    body(size_t{0}, std::min(n, per_shard));
+    done.wait();
+}
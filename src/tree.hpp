@@ -1,14 +1,20 @@
 #pragma once
 
+#include "criteria.hpp"
 #include "dataset.hpp"
 #include "node.hpp"
 
 #include <algorithm>
+#include <array>
 #include <bitset>
+#include <cmath>
+#include <cstdint>
 #include <fmt/core.h>
 #include <iostream>
 #include <map>
+#include <numeric>
 #include <random>
+#include <span>
 #include <vector>
 
 std::pair<std::pair<std::vector<std::vector<int>>, std::vector<int>>, std::pair<std::vector<std::vector<int>>, std::vector<int>>> inline train_test_split(
@@ -52,6 +58,14 @@ inline void print_tree(const Node &node, int depth = 0)
     {
         std::cout << indent << "[Leaf: label=" << node.leaf_label() << "]\n";
     }
+    else if (node.is_threshold())
+    {
+        std::cout << indent << "[Node: attribte=" << node.split_attribute() << " <= " << node.threshold() << "]\n";
+        for (const auto &child : node.children())
+        {
+            print_tree(child, depth + 1);
+        }
+    }
     else
     {
         std::cout << indent << "[Node: attribte=" << node.split_attribute() << "]\n";
@@ -62,47 +76,110 @@ inline void print_tree(const Node &node, int depth = 0)
     }
 }
 
-inline int tree_predict(const std::vector<int> &obs, const Node &node)
+inline size_t count_nodes(const Node &node)
+{
+    size_t count = 1;
+    for (const auto &child : node.children())
+    {
+        count += count_nodes(child);
+    }
+    return count;
+}
+
+inline size_t tree_depth(const Node &node)
+{
+    size_t depth = 0;
+    for (const auto &child : node.children())
+    {
+        depth = std::max(depth, tree_depth(child) + 1);
+    }
+    return depth;
+}
+
+// The shortest observation tree_predict can be given: one past the highest attribute the tree splits on.
+inline size_t tree_input_width(const Node &node)
+{
+    if (node.is_leaf())
+        return 0;
+
+    size_t width = static_cast<size_t>(node.split_attribute()) + 1;
+    for (const auto &child : node.children())
+    {
+        width = std::max(width, tree_input_width(child));
+    }
+    return width;
+}
+
+// The child a categorical split sends values none of its children was trained on to: the one for the smallest value.
+// That is the first child as built, and stays the same child when the children are reordered.
+inline const Node &fallback_child(const Node &node)
+{
+    return *std::ranges::min_element(node.children(), {}, &Node::inter_label);
+}
+
+// tree_predict on any observation whose attribute values `obs[attribute]` reads, such as a row of strided columns.
+template <typename Observation>
+inline int tree_predict_at(const Observation &obs, const Node &node)
 {
     if (node.is_leaf())
     {
         return node.leaf_label();
     }
+    else if (node.is_threshold())
+    {
+        const bool right = obs[static_cast<size_t>(node.split_attribute())] > node.threshold();
+        return tree_predict_at(obs, node.children()[right]);
+    }
     else
     {
-        const int split_val = obs[node.split_attribute()];
+        const int split_val = obs[static_cast<size_t>(node.split_attribute())];
         auto child = std::ranges::find_if(node.children(), [split_val](const Node &n) { return n.inter_label() == split_val; });
         if (child == node.children().end()) [[unlikely]]
         {
-            return tree_predict(obs, node.children().front());
+            return tree_predict_at(obs, fallback_child(node));
         }
 
-        return tree_predict(obs, *child);
+        return tree_predict_at(obs, *child);
     }
 }
 
-inline float split_entropy(Dataset &ds, int attribute)
+inline int tree_predict(std::span<const int> obs, const Node &node) { return tree_predict_at(obs, node); }
+
+// Scores splitting `ds` on `attribute` under `Criterion`; lower is better. `ds` must already be sorted by `attribute`.
+// Criteria that exit early stop once the partitions scored so far reach `bound` and return infinity, as the split can
+// no longer score below it.
+template <typename Criterion>
+inline float split_score(Dataset &ds, int attribute, float parent_impurity = 0, float bound = std::numeric_limits<float>::max())
 {
-    float total_entropy = 0;
+    float total_impurity = 0;
+    float split_info = 0;
+
+    int node_weight = 0;
+    if constexpr (Criterion::uses_split_info)
+    {
+        node_weight = ds.total_weight();
+    }
 
-    const auto compute_entropy = [](int total, const std::vector<int> &counts)
+    auto &cnts = ds.count_scratch_buf();
+    const std::span<const int> class_cnts(cnts.data(), ds.num_classes());
+
+    const auto close_partition = [&](int total)
     {
-        float entropy = 0;
-        for (auto cnt : counts)
+        // Rows can weigh nothing, and a partition of them changes nothing.
+        if (total == 0)
+            return;
+
+        total_impurity += Criterion::impurity(total, class_cnts);
+        if constexpr (Criterion::uses_split_info)
         {
-            if (cnt == 0)
-                continue;
-            float prop = static_cast<float>(cnt) / total;
-            entropy -= prop * log(prop);
+            split_info += Criterion::split_info(total, node_weight);
         }
-        return entropy * total;
+        std::memset(cnts.data(), 0, class_cnts.size() * sizeof(int));
     };
 
-    auto &cnts = ds.count_scratch_buf();
-
-    int split_start = 0;
-    auto prev_label = ds.get_row_sorted(0)[attribute];
-    int row = 0;
+    int partition_weight = 0;
+    auto prev_label = ds.get_col_sorted(attribute, 0);
+    size_t row = 0;
     while (row < ds.num_rows())
     {
         const auto cur_label = ds.get_col_sorted(attribute, row);
@@ -110,79 +187,430 @@ inline float split_entropy(Dataset &ds, int attribute)
         if (cur_label == prev_label)
         {
             const auto label = ds.get_target_sorted(row);
-            ++cnts[label];
+            const auto weight = ds.get_weight_sorted(row);
+            cnts[label] += weight;
+            partition_weight += weight;
             ++row;
         }
         else
         {
-            total_entropy += compute_entropy(row - split_start, cnts);
-
-            split_start = row;
+            close_partition(partition_weight);
+            if constexpr (Criterion::exits_early)
+            {
+                if (total_impurity >= bound)
+                    return std::numeric_limits<float>::infinity();
+            }
+
+            partition_weight = 0;
             prev_label = cur_label;
-            std::memset(cnts.data(), 0, cnts.size() * sizeof(int));
         }
     }
 
-    if (row > split_start)
+    if (row > 0)
     {
-        total_entropy += compute_entropy(row - split_start, cnts);
-        std::memset(cnts.data(), 0, cnts.size() * sizeof(int));
+        close_partition(partition_weight);
     }
 
-    return total_entropy;
+    return Criterion::score(total_impurity, parent_impurity, split_info);
 }
 
-inline Node id3(Dataset dataset, std::bitset<64> used_attributes, int parent_mode, int min_samples_split)
+inline float split_entropy(Dataset &ds, int attribute) { return split_score<Entropy>(ds, attribute); }
+
+template <typename Criterion>
+inline float node_impurity(Dataset &ds)
 {
+    auto &cnts = ds.count_scratch_buf();
+    int total = 0;
+    for (size_t row = 0; row < ds.num_rows(); ++row)
+    {
+        cnts[ds.get_target_sorted(row)] += ds.get_weight_sorted(row);
+        total += ds.get_weight_sorted(row);
+    }
+
+    const auto impurity = Criterion::impurity(total, std::span<const int>(cnts.data(), ds.num_classes()));
+    std::memset(cnts.data(), 0, ds.num_classes() * sizeof(int));
+    return impurity;
+}
+
+struct ThresholdSplit
+{
+    float score = std::numeric_limits<float>::max();
+    int threshold = 0;
+    size_t left_size = 0;
+};
+
+// Finds the best binary split of numeric `attribute` with a single pass over the node's presorted rows, moving one row
+// at a time from the right-hand class counts to the left-hand ones and scoring every boundary between distinct values.
+template <typename Criterion>
+inline ThresholdSplit best_threshold(Dataset &ds, int attribute, float parent_impurity = 0)
+{
+    const int *order = ds.numeric_order(attribute);
+    const size_t n = ds.num_rows();
+    auto left = ds.left_counts();
+    auto right = ds.right_counts();
+
+    int total = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        right[ds.get_target(order[i])] += ds.get_weight(order[i]);
+        total += ds.get_weight(order[i]);
+    }
+
+    ThresholdSplit best;
+    int nleft = 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        const int row = order[i];
+        const int label = ds.get_target(row);
+        const int weight = ds.get_weight(row);
+        left[label] += weight;
+        right[label] -= weight;
+        nleft += weight;
+
+        const int value = ds.get_col(attribute, row);
+        if (value == ds.get_col(attribute, order[i + 1]))
+            continue;
+
+        const int nright = total - nleft;
+        const float impurity = Criterion::impurity(nleft, left) + Criterion::impurity(nright, right);
+        float split_info = 0;
+        if constexpr (Criterion::uses_split_info)
+        {
+            split_info = Criterion::split_info(nleft, total) + Criterion::split_info(nright, total);
+        }
+
+        const float score = Criterion::score(impurity, parent_impurity, split_info);
+        if (score < best.score)
+        {
+            best = {score, value, i + 1};
+        }
+    }
+
+    std::ranges::fill(left, 0);
+    std::ranges::fill(right, 0);
+    return best;
+}
+
+// Where a build's split search went, for judging how much of it the shortcuts below save. Each candidate attribute at a
+// split node counts as one evaluation; the other counters are the evaluations cut short.
+struct BuildStats
+{
+    size_t nodes = 0;
+    size_t evaluations = 0;
+    // Attributes with a single value in the node, dropped without sorting.
+    size_t constant_skips = 0;
+    // Attributes ruled out on a row sample.
+    size_t sample_skips = 0;
+    // Attributes whose scoring stopped once their first partitions could no longer beat the best split.
+    size_t early_exits = 0;
+};
+
+struct BuildOptions
+{
+    int min_samples_split = 2;
+    // Nodes this many splits below the root become leaves.
+    int max_depth = std::numeric_limits<int>::max();
+    // Nodes with at least this many rows narrow their categorical candidates on a sample of sample_size rows before
+    // scoring the survivors exactly; 0 scores every candidate on every row.
+    size_t sample_threshold = 0;
+    size_t sample_size = 4096;
+    // Bound on the probability that a sampled node drops the attribute exact scoring would have picked.
+    double sample_delta = 1e-6;
+    uint64_t seed = 0;
+    // Accumulates the build's BuildStats when set.
+    BuildStats *stats = nullptr;
+    // Train the row-data overloads of build_tree on unique rows weighted by their count; the tree is the same.
+    bool collapse_duplicates = false;
+    // Nodes with at most this many rows build their subtree on a compact copy of their rows (Dataset::localize); the
+    // tree is the same. Only for data without numeric columns, and only below sample_threshold, where the sample a
+    // node draws depends on where its rows sit; 0 never copies.
+    size_t local_threshold = 16384;
+};
+
+// Scores splitting on categorical `attribute` using only the context rows in `sample`: one pass fills a value-by-class
+// count table, so nothing is sorted. Scaled like split_score on a node made of the sampled rows.
+template <typename Criterion>
+inline float sampled_split_score(Dataset &ds, std::span<const int> sample, int attribute)
+{
+    const size_t nclasses = ds.num_classes();
+    auto joint = ds.joint_counts();
+
+    int max_value = 0;
+    int sample_weight = 0;
+    for (int row : sample)
+    {
+        const int value = ds.get_col(attribute, row);
+        joint[static_cast<size_t>(value) * nclasses + static_cast<size_t>(ds.get_target(row))] += ds.get_weight(row);
+        max_value = std::max(max_value, value);
+        sample_weight += ds.get_weight(row);
+    }
+
+    float parent_impurity = 0;
+    if constexpr (Criterion::uses_parent_impurity)
+    {
+        auto cnts = ds.left_counts();
+        for (int row : sample)
+        {
+            cnts[ds.get_target(row)] += ds.get_weight(row);
+        }
+        parent_impurity = Criterion::impurity(sample_weight, cnts);
+        std::ranges::fill(cnts, 0);
+    }
+
+    float total_impurity = 0;
+    float split_info = 0;
+    for (size_t value = 0; value <= static_cast<size_t>(max_value); ++value)
+    {
+        const auto counts = joint.subspan(value * nclasses, nclasses);
+        const int total = std::accumulate(counts.begin(), counts.end(), 0);
+        if (total == 0)
+            continue;
+
+        total_impurity += Criterion::impurity(total, counts);
+        if constexpr (Criterion::uses_split_info)
+        {
+            split_info += Criterion::split_info(total, sample_weight);
+        }
+        std::ranges::fill(counts, 0);
+    }
+
+    return Criterion::score(total_impurity, parent_impurity, split_info);
+}
+
+// Narrows the categorical `candidates` of a large node by scoring them on rows drawn uniformly from it. A candidate is
+// dropped only when its sampled score trails the best one's by more than the Hoeffding bound on both estimates, so
+// the attribute exact scoring would choose survives with probability at least 1 - sample_delta. Unless the top
+// candidates are close, one is left.
+template <typename Criterion>
+inline std::bitset<64> sampled_candidates(Dataset &ds, std::bitset<64> candidates, const BuildOptions &options)
+{
+    const auto k = candidates.count();
+    const double range = Criterion::score_range(ds.num_classes());
+    if (k < 2 || !std::isfinite(range))
+        return candidates;
+
+    auto &sample = ds.sample_buf();
+    sample.resize(options.sample_size);
+    std::mt19937_64 gen(options.seed ^ (ds.num_rows() * 0x9E3779B97F4A7C15ULL) ^ static_cast<uint64_t>(ds.row_index(0)));
+    std::uniform_int_distribution<size_t> pick(0, ds.num_rows() - 1);
+    for (auto &row : sample)
+    {
+        row = ds.row_index(pick(gen));
+    }
+
+    int sample_weight = 0;
+    for (int row : sample)
+    {
+        sample_weight += ds.get_weight(row);
+    }
+    if (sample_weight == 0)
+        return candidates;
+
+    std::array<double, 64> scores{};
+    double best = std::numeric_limits<double>::max();
+    for (size_t col = 0; col < ds.num_attributes(); ++col)
+    {
+        if (!candidates.test(col))
+            continue;
+        scores[col] = sampled_split_score<Criterion>(ds, sample, static_cast<int>(col)) / static_cast<double>(sample_weight);
+        best = std::min(best, scores[col]);
+    }
+
+    const double eps = range * std::sqrt(std::log(2.0 * static_cast<double>(k) / options.sample_delta) / (2.0 * static_cast<double>(sample.size())));
+    for (size_t col = 0; col < ds.num_attributes(); ++col)
+    {
+        if (candidates.test(col) && scores[col] > best + 2 * eps)
+        {
+            candidates.reset(col);
+        }
+    }
+    return candidates;
+}
+
+template <typename Criterion = Entropy>
+inline Node id3(Dataset dataset, std::bitset<64> used_attributes, int parent_mode, const BuildOptions &options, int depth = 0)
+{
+    if (dataset.num_rows() <= options.local_threshold && dataset.num_rows() > 0 && !dataset.is_local() && !dataset.has_numeric() &&
+        (options.sample_threshold == 0 || dataset.num_rows() < options.sample_threshold))
+    {
+        return id3<Criterion>(dataset.localize(used_attributes), used_attributes, parent_mode, options, depth);
+    }
+
+    const auto tally = [&options](size_t BuildStats::*counter, size_t n = 1)
+    {
+        if (options.stats)
+            options.stats->*counter += n;
+    };
+    tally(&BuildStats::nodes);
+
     if (dataset.num_rows() == 0)
     {
-        return Node::make_leaf(parent_mode);
+        auto leaf = Node::make_leaf(parent_mode);
+        leaf.set_stats({0, 0, parent_mode});
+        return leaf;
     }
 
-    auto [mode_label, mode_count] = dataset.mode_label();
+    const NodeStats stats = dataset.node_stats();
+    const int mode_label = stats.mode_label;
+    const auto with_stats = [&stats](Node node)
+    {
+        node.set_stats(stats);
+        return node;
+    };
+
+    if (stats.mode_count == stats.num_samples || used_attributes.count() == dataset.num_attributes() || stats.num_samples <= options.min_samples_split ||
+        depth >= options.max_depth)
+    {
+        return with_stats(Node::make_leaf(mode_label));
+    }
 
-    if (mode_count == dataset.num_rows() || used_attributes.size() == dataset.num_attributes() || dataset.num_rows() <= min_samples_split)
+    float parent_impurity = 0;
+    if constexpr (Criterion::uses_parent_impurity)
     {
-        return Node::make_leaf(mode_label);
+        parent_impurity = node_impurity<Criterion>(dataset);
     }
 
     float best_split_entropy = std::numeric_limits<float>::max();
-    int best_split_attribute = 0;
-    Dataset best_ds;
+    int best_split_attribute = -1;
+    int last_sorted = -1;
+    ThresholdSplit best_threshold_split;
+
+    // A single-valued split tells nothing, so constant attributes are dropped up front; if nothing is left the node
+    // becomes a leaf.
+    std::bitset<64> candidates;
+    for (size_t col = 0; col < dataset.num_attributes(); ++col)
+    {
+        if (dataset.is_numeric(col) || used_attributes.test(col))
+            continue;
+
+        tally(&BuildStats::evaluations);
+        if (dataset.is_constant(col))
+        {
+            tally(&BuildStats::constant_skips);
+            continue;
+        }
+        candidates.set(col);
+    }
+    if (options.sample_threshold > 0 && dataset.num_rows() >= options.sample_threshold && dataset.num_rows() > options.sample_size)
+    {
+        const auto before = candidates.count();
+        candidates = sampled_candidates<Criterion>(dataset, candidates, options);
+        tally(&BuildStats::sample_skips, before - candidates.count());
+    }
 
     for (int col = 0; col < dataset.num_attributes(); ++col)
     {
-        if (used_attributes.test(col))
+        if (dataset.is_numeric(col))
+        {
+            tally(&BuildStats::evaluations);
+            const int *order = dataset.numeric_order(col);
+            if (dataset.get_col(col, order[0]) == dataset.get_col(col, order[dataset.num_rows() - 1]))
+            {
+                tally(&BuildStats::constant_skips);
+                continue;
+            }
+
+            const auto split = best_threshold<Criterion>(dataset, col, parent_impurity);
+            if (split.score < best_split_entropy)
+            {
+                best_split_entropy = split.score;
+                best_split_attribute = col;
+                best_threshold_split = split;
+            }
+            continue;
+        }
+
+        if (!candidates.test(col))
             continue;
 
         dataset.sort_by(col);
+        last_sorted = col;
 
-        const auto entropy = split_entropy(dataset, col);
-        if (entropy < best_split_entropy)
+        const auto entropy = split_score<Criterion>(dataset, col, parent_impurity, best_split_entropy);
+        if (std::isinf(entropy))
+        {
+            tally(&BuildStats::early_exits);
+        }
+        else if (entropy < best_split_entropy)
         {
             best_split_entropy = entropy;
             best_split_attribute = col;
-            best_ds = dataset;
+            best_threshold_split = {};
+            dataset.save_order();
         }
     }
 
+    if (best_split_attribute < 0)
+    {
+        return with_stats(Node::make_leaf(mode_label));
+    }
+
+    if (dataset.is_numeric(best_split_attribute))
+    {
+        const auto [_, threshold, left_size] = best_threshold_split;
+        dataset.partition_threshold(best_split_attribute, threshold);
+
+        auto left = id3<Criterion>(dataset.slice(0, left_size), used_attributes, mode_label, options, depth + 1);
+        auto right = id3<Criterion>(dataset.slice(left_size, dataset.num_rows()), used_attributes, mode_label, options, depth + 1);
+        return with_stats(Node::make_threshold(best_split_attribute, threshold, std::move(left), std::move(right)));
+    }
+
+    if (last_sorted != best_split_attribute)
+    {
+        dataset.restore_order();
+    }
+
+    if (dataset.has_numeric())
+    {
+        dataset.partition_numeric(best_split_attribute);
+    }
+
     used_attributes.set(best_split_attribute);
 
     std::vector<Node> children;
-    for (const auto split_ds : best_ds.split_iterator(best_split_attribute))
+    for (const auto split_ds : dataset.split_iterator(best_split_attribute))
     {
-        auto label = split_ds.get_row_sorted(0)[best_split_attribute];
-        auto n = id3(split_ds, used_attributes, mode_label, min_samples_split);
+        auto label = split_ds.get_col_sorted(best_split_attribute, 0);
+        auto n = id3<Criterion>(split_ds, used_attributes, mode_label, options, depth + 1);
         n.set_inter_label(label);
         children.push_back(std::move(n));
     }
 
-    return Node::make_inter(best_split_attribute, std::move(children));
+    return with_stats(Node::make_inter(best_split_attribute, std::move(children)));
 }
 
-inline Node build_tree(std::vector<std::vector<int>> row_data, std::vector<int> target_data, int min_samples_split = 2)
+// Builds on whatever rows are currently selected in `ctx`. The context can be reassigned or reselected and built on again.
+template <typename Criterion = Entropy>
+inline Node build_tree(TrainingContext &ctx, const BuildOptions &options)
 {
-    Dataset ds(new InnerDataset(std::move(row_data), std::move(target_data)));
+    return id3<Criterion>(ctx.begin_build(), 0, 0, options);
+}
 
-    return id3(ds, 0, 0, min_samples_split);
+template <typename Criterion = Entropy>
+inline Node build_tree(TrainingContext &ctx, int min_samples_split = 2)
+{
+    return build_tree<Criterion>(ctx, BuildOptions{.min_samples_split = min_samples_split});
+}
+
+template <typename Criterion = Entropy>
+inline Node build_tree(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, const BuildOptions &options)
+{
+    TrainingContext ctx;
+    if (options.collapse_duplicates)
+    {
+        const auto unique = collapse_duplicates(row_data, target_data);
+        ctx.assign_weighted(unique.rows, unique.target, unique.weights);
+    }
+    else
+    {
+        ctx.assign(row_data, target_data);
+    }
+
+    return build_tree<Criterion>(ctx, options);
+}
+
+template <typename Criterion = Entropy>
+inline Node build_tree(const std::vector<std::vector<int>> &row_data, const std::vector<int> &target_data, int min_samples_split = 2)
+{
+    return build_tree<Criterion>(row_data, target_data, BuildOptions{.min_samples_split = min_samples_split});
 }
@@ -0,0 +1,182 @@
+#include "tree_race.h"
+
+#include "batch_predict.hpp"
+#include "dataset.hpp"
+#include "serialize.hpp"
+#include "tree.hpp"
+
+#include <bitset>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(int) == sizeof(int32_t));
+
+struct tr_tree
+{
+    Node root;
+};
+
+namespace
+{
+thread_local std::string last_error;
+
+template <typename F>
+tr_status guarded(F &&f)
+{
+    try
+    {
+        f();
+        return TR_OK;
+    }
+    catch (const std::invalid_argument &e)
+    {
+        last_error = e.what();
+        return TR_INVALID_ARGUMENT;
+    }
+    catch (const std::bad_alloc &)
+    {
+        last_error = "out of memory";
+        return TR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception &e)
+    {
+        last_error = e.what();
+        return TR_ERROR;
+    }
+    catch (...)
+    {
+        last_error = "unknown error";
+        return TR_ERROR;
+    }
+}
+
+void require(bool condition, const char *message)
+{
+    if (!condition)
+    {
+        throw std::invalid_argument(message);
+    }
+}
+
+std::vector<StridedColumn> to_columns(const tr_column *columns, size_t num_columns, size_t num_rows)
+{
+    require(columns != nullptr || num_columns == 0, "columns is null");
+    std::vector<StridedColumn> cols(num_columns);
+    for (size_t i = 0; i < num_columns; ++i)
+    {
+        require(columns[i].data != nullptr || num_rows == 0, "column data is null");
+        cols[i] = {columns[i].data, columns[i].stride};
+    }
+    return cols;
+}
+
+// Categorical values and labels index count buffers, so they are checked before training on them.
+void require_non_negative(StridedColumn col, size_t num_rows, const char *message)
+{
+    for (size_t i = 0; i < num_rows; ++i)
+    {
+        require(col[i] >= 0, message);
+    }
+}
+
+template <typename Criterion>
+Node build(TrainingContext &ctx, const tr_build_options &options)
+{
+    return build_tree<Criterion>(ctx, BuildOptions{.min_samples_split = options.min_samples_split, .max_depth = options.max_depth});
+}
+} // namespace
+
+extern "C"
+{
+    void tr_build_options_init(tr_build_options *options)
+    {
+        const BuildOptions defaults;
+        *options = {TR_ENTROPY, defaults.min_samples_split, defaults.max_depth, 0};
+    }
+
+    tr_status tr_build_tree(const tr_column *columns, size_t num_columns, tr_column target, size_t num_rows, const tr_build_options *options,
+                            tr_tree **out)
+    {
+        return guarded(
+            [&]
+            {
+                require(out != nullptr, "out is null");
+                require(num_columns <= 64, "at most 64 columns are supported");
+                require(target.data != nullptr || num_rows == 0, "target data is null");
+                tr_build_options opts;
+                tr_build_options_init(&opts);
+                if (options)
+                {
+                    opts = *options;
+                }
+
+                const auto cols = to_columns(columns, num_columns, num_rows);
+                const StridedColumn target_col{target.data, target.stride};
+                const std::bitset<64> numeric(opts.numeric);
+                for (size_t col = 0; col < cols.size(); ++col)
+                {
+                    if (!numeric.test(col))
+                        require_non_negative(cols[col], num_rows, "negative categorical value");
+                }
+                require_non_negative(target_col, num_rows, "negative label");
+
+                TrainingContext ctx;
+                ctx.assign_columns(cols, target_col, num_rows, numeric);
+
+                const auto root = [&]
+                {
+                    switch (opts.criterion)
+                    {
+                    case TR_ENTROPY:
+                        return build<Entropy>(ctx, opts);
+                    case TR_GAIN_RATIO:
+                        return build<GainRatio>(ctx, opts);
+                    case TR_GINI:
+                        return build<Gini>(ctx, opts);
+                    }
+                    throw std::invalid_argument("unknown criterion");
+                };
+                *out = new tr_tree{root()};
+            });
+    }
+
+    tr_status tr_predict(const tr_tree *tree, const tr_column *columns, size_t num_columns, size_t num_rows, int32_t *out)
+    {
+        return guarded(
+            [&]
+            {
+                require(tree != nullptr, "tree is null");
+                require(out != nullptr || num_rows == 0, "out is null");
+                const auto cols = to_columns(columns, num_columns, num_rows);
+                predict_columns(tree->root, cols, {out, num_rows});
+            });
+    }
+
+    size_t tr_tree_input_width(const tr_tree *tree) { return tree ? tree_input_width(tree->root) : 0; }
+
+    tr_status tr_save_tree(const tr_tree *tree, const char *path)
+    {
+        return guarded(
+            [&]
+            {
+                require(tree != nullptr && path != nullptr, "tree or path is null");
+                save_tree(tree->root, std::string(path));
+            });
+    }
+
+    tr_status tr_load_tree(const char *path, tr_tree **out)
+    {
+        return guarded(
+            [&]
+            {
+                require(path != nullptr && out != nullptr, "path or out is null");
+                *out = new tr_tree{load_tree(std::string(path))};
+            });
+    }
+
+    void tr_free_tree(tr_tree *tree) { delete tree; }
+
+    const char *tr_last_error(void) { return last_error.c_str(); }
+}
@@ -0,0 +1,80 @@
+/* Stable C interface for training and scoring on caller-owned memory, for FFI from Python, Arrow consumers and the
+ * like. Tables are passed as columns: a pointer to the first value and a stride in values, so a numpy array in either
+ * order or a set of Arrow int32 buffers is handed over without being copied into rows first. Values and labels are
+ * int32; categorical values and labels must not be negative.
+ *
+ * Every function that can fail returns a tr_status and leaves a message for tr_last_error on the calling thread.
+ * Handles are not shared between threads while one of them frees it. */
+#ifndef TREE_RACE_H
+#define TREE_RACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum tr_status
+    {
+        TR_OK = 0,
+        TR_INVALID_ARGUMENT = 1,
+        TR_OUT_OF_MEMORY = 2,
+        TR_ERROR = 3,
+    } tr_status;
+
+    typedef enum tr_criterion
+    {
+        TR_ENTROPY = 0,
+        TR_GAIN_RATIO = 1,
+        TR_GINI = 2,
+    } tr_criterion;
+
+    /* `stride` is in values, not bytes: 1 for a contiguous column, the row width for a column of a row-major array. */
+    typedef struct tr_column
+    {
+        const int32_t *data;
+        size_t stride;
+    } tr_column;
+
+    typedef struct tr_build_options
+    {
+        tr_criterion criterion;
+        int32_t min_samples_split;
+        int32_t max_depth;
+        /* Bit i set splits column i on thresholds instead of per value. */
+        uint64_t numeric;
+    } tr_build_options;
+
+    typedef struct tr_tree tr_tree;
+
+    /* The defaults build_tree uses. */
+    void tr_build_options_init(tr_build_options *options);
+
+    /* Trains on `num_rows` rows given as `num_columns` attribute columns and a label column. Contiguous columns are read
+     * in place; the memory only needs to outlive the call. `options` may be NULL for the defaults. */
+    tr_status tr_build_tree(const tr_column *columns, size_t num_columns, tr_column target, size_t num_rows, const tr_build_options *options,
+                            tr_tree **out);
+
+    /* Writes the predicted label of each of `num_rows` rows to `out`. Needs at least tr_tree_input_width columns. */
+    tr_status tr_predict(const tr_tree *tree, const tr_column *columns, size_t num_columns, size_t num_rows, int32_t *out);
+
+    /* The number of columns tr_predict reads: one past the highest attribute the tree splits on. */
+    size_t tr_tree_input_width(const tr_tree *tree);
+
+    tr_status tr_save_tree(const tr_tree *tree, const char *path);
+
+    tr_status tr_load_tree(const char *path, tr_tree **out);
+
+    /* Accepts NULL. */
+    void tr_free_tree(tr_tree *tree);
+
+    /* The message of the last failed call on this thread, valid until the next call that fails. */
+    const char *tr_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+#include "batch_predict.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <mutex>
+
+TEST(ParallelForTest, CoversRangeInAlignedShards)
+{
+    ThreadPool pool(4);
+    for (size_t n : {0, 1, 15, 16, 17, 100, 1000})
+    {
+        std::mutex mutex;
+        std::vector<std::pair<size_t, size_t>> ranges;
+        parallel_for(pool, n, 16,
+                     [&](size_t begin, size_t end)
+                     {
+                         std::lock_guard lock(mutex);
+                         ranges.emplace_back(begin, end);
+                     });
+
+        std::ranges::sort(ranges);
+        size_t next = 0;
+        for (const auto &[begin, end] : ranges)
+        {
+            EXPECT_EQ(begin, next);
+            EXPECT_LT(begin, end);
+            EXPECT_EQ(begin % 16, 0);
+            next = end;
+        }
+        EXPECT_EQ(next, n);
+        EXPECT_LE(ranges.size(), pool.size());
+    }
+}
+
+TEST(BatchPredictTest, MatchesTreePredict)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+    const auto flat = flatten_rows(row_data);
+
+    for (size_t threads : {1, 3, 8})
+    {
+        ThreadPool pool(threads);
+        // Offsetting the output exercises the unaligned head.
+        for (size_t offset : {0, 5})
+        {
+            std::vector<int> out(row_data.size() + offset, -1);
+            predict_batch(tree, flat, 6, std::span(out).subspan(offset), pool);
+            for (size_t i = 0; i < row_data.size(); ++i)
+            {
+                ASSERT_EQ(out[i + offset], tree_predict(row_data[i], tree));
+            }
+        }
+    }
+
+    ThreadPool pool(2);
+    std::vector<int> out(row_data.size());
+    EXPECT_THROW(predict_batch(tree, std::span(flat).first(flat.size() - 6), 6, out, pool), std::invalid_argument);
+    std::vector<int> narrow(flat.size() / 3);
+    EXPECT_THROW(predict_batch(tree, flat, 3, narrow, pool), std::invalid_argument);
+}
+
+TEST(BatchPredictTest, PredictColumnsMatchesTreePredict)
+{
+    auto [row_data, target_data] = load_car_data();
+    TrainingContext ctx(row_data, target_data, 0b100001);
+    const auto tree = build_tree(ctx);
+    const auto flat = flatten_rows(row_data);
+    const size_t width = row_data[0].size();
+
+    std::vector<StridedColumn> cols(width);
+    for (size_t j = 0; j < width; ++j)
+    {
+        cols[j] = {flat.data() + j, width};
+    }
+    std::vector<int> out(row_data.size());
+    predict_columns(tree, cols, out);
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        EXPECT_EQ(out[i], tree_predict(row_data[i], tree));
+    }
+
+    EXPECT_THROW(predict_columns(tree, std::span(cols).first(1), out), std::invalid_argument);
+}
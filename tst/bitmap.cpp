@@ -0,0 +1,101 @@
+#include "bitmap.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+// Low-cardinality attributes with noisy labels, enough rows for nodes to span many AVX-512 registers.
+std::pair<std::vector<std::vector<int>>, std::vector<int>> make_low_cardinality_data(size_t rows, int classes)
+{
+    std::mt19937 gen(11);
+    std::vector<std::vector<int>> row_data(rows, std::vector<int>(7));
+    std::vector<int> target(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t col = 0; col < row_data[i].size(); ++col)
+        {
+            row_data[i][col] = static_cast<int>(gen() % (2 + col % 4));
+        }
+        target[i] = gen() % 8 == 0 ? static_cast<int>(gen() % classes) : (row_data[i][1] + row_data[i][3] * row_data[i][4]) % classes;
+    }
+    return {row_data, target};
+}
+
+template <typename Criterion>
+void expect_same_trees(const std::vector<std::vector<int>> &rows, const std::vector<int> &target, const BuildOptions &options)
+{
+    BuildStats index_stats;
+    BuildStats bitmap_stats;
+    BuildOptions index_options = options;
+    BuildOptions bitmap_options = options;
+    index_options.stats = &index_stats;
+    bitmap_options.stats = &bitmap_stats;
+
+    TrainingContext ctx(rows, target);
+    const auto expected = build_tree<Criterion>(ctx, index_options);
+
+    BitmapContext bitmaps(rows, target);
+    for (const auto kernel : {PopcountKernel::Scalar, PopcountKernel::Avx2, PopcountKernel::Avx512})
+    {
+        if (!popcount_kernel_supported(kernel))
+            continue;
+
+        bitmaps.set_kernel(kernel);
+        bitmap_stats = {};
+        EXPECT_EQ(build_tree<Criterion>(bitmaps, bitmap_options), expected);
+        EXPECT_EQ(bitmap_stats.nodes, index_stats.nodes);
+        EXPECT_EQ(bitmap_stats.evaluations, index_stats.evaluations);
+        EXPECT_EQ(bitmap_stats.constant_skips, index_stats.constant_skips);
+        EXPECT_EQ(bitmap_stats.early_exits, index_stats.early_exits);
+    }
+}
+} // namespace
+
+TEST(BitmapTest, KernelsAgree)
+{
+    std::mt19937_64 gen(2);
+    for (size_t n = 0; n < 70; ++n)
+    {
+        std::vector<uint64_t> a(n), b(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = gen();
+            b[i] = gen();
+        }
+
+        std::vector<uint64_t> expected(n);
+        const auto count = and_popcount(PopcountKernel::Scalar, a.data(), b.data(), n, expected.data());
+        for (const auto kernel : {PopcountKernel::Avx2, PopcountKernel::Avx512})
+        {
+            if (!popcount_kernel_supported(kernel))
+                continue;
+
+            std::vector<uint64_t> out(n);
+            EXPECT_EQ(and_popcount(kernel, a.data(), b.data(), n), count);
+            EXPECT_EQ(and_popcount(kernel, a.data(), b.data(), n, out.data()), count);
+            EXPECT_EQ(out, expected);
+        }
+    }
+    EXPECT_TRUE(popcount_kernel_supported(best_popcount_kernel()));
+}
+
+TEST(BitmapTest, SameTreesAsIndexPath)
+{
+    auto [tennis_rows, tennis_target] = load_tennis_data();
+    expect_same_trees<Entropy>(tennis_rows, tennis_target, {});
+
+    auto [car_rows, car_target] = load_car_data();
+    expect_same_trees<Entropy>(car_rows, car_target, {});
+    expect_same_trees<Gini>(car_rows, car_target, {});
+    expect_same_trees<GainRatio>(car_rows, car_target, {});
+    expect_same_trees<Entropy>(car_rows, car_target, {.min_samples_split = 20, .max_depth = 3});
+
+    auto [rows, target] = make_low_cardinality_data(20'000, 3);
+    expect_same_trees<Entropy>(rows, target, {});
+    expect_same_trees<Gini>(rows, target, {.min_samples_split = 50});
+    std::tie(rows, target) = make_low_cardinality_data(3'000, 2);
+    expect_same_trees<GainRatio>(rows, target, {});
+}
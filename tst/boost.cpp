@@ -0,0 +1,75 @@
+#include "batch_predict.hpp"
+#include "boost.hpp"
+#include "datasets.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+double accuracy(const BoostedEnsemble &ensemble, const std::vector<std::vector<int>> &rows, const std::vector<int> &target)
+{
+    size_t correct = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        correct += ensemble.predict(rows[i]) == target[i];
+    }
+    return static_cast<double>(correct) / static_cast<double>(rows.size());
+}
+} // namespace
+
+TEST(BoostTest, MaxDepthLimitsTree)
+{
+    auto [row_data, target_data] = load_car_data();
+    TrainingContext ctx(row_data, target_data);
+    EXPECT_EQ(tree_depth(build_tree(ctx, {.max_depth = 2})), 2);
+    EXPECT_EQ(tree_depth(build_tree(ctx, {.max_depth = 0})), 0);
+    EXPECT_EQ(build_tree(ctx, {.max_depth = 100}), build_tree(ctx));
+}
+
+TEST(BoostTest, SetWeightsMatchesAssignWeighted)
+{
+    auto [row_data, target_data] = load_car_data();
+    std::vector<int> weights(row_data.size());
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        weights[i] = static_cast<int>(i % 5);
+    }
+
+    TrainingContext weighted;
+    weighted.assign_weighted(row_data, target_data, weights);
+    TrainingContext ctx(row_data, target_data);
+    const auto unweighted = build_tree(ctx);
+    ctx.set_weights(weights);
+    EXPECT_EQ(build_tree(ctx), build_tree(weighted));
+    EXPECT_NE(build_tree(ctx), unweighted);
+    EXPECT_THROW(ctx.set_weights(std::vector<int>{1, 2}), std::invalid_argument);
+}
+
+TEST(BoostTest, BoostingBeatsOneStump)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto one = boost_trees(row_data, target_data, {.rounds = 1});
+    const auto many = boost_trees(row_data, target_data, {.rounds = 40, .max_depth = 2});
+    ASSERT_EQ(one.size(), 1);
+    EXPECT_GT(many.size(), 1);
+    EXPECT_LE(many.size(), 40);
+    EXPECT_GT(accuracy(many, row_data, target_data), accuracy(one, row_data, target_data) + 0.05);
+
+    // A perfect first tree ends boosting and decides alone.
+    const auto full = boost_trees(row_data, target_data, {.rounds = 10, .max_depth = 100, .min_samples_split = 0});
+    ASSERT_EQ(full.size(), 1);
+    EXPECT_EQ(accuracy(full, row_data, target_data), 1.0);
+}
+
+TEST(BoostTest, BatchMatchesSingle)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto ensemble = boost_trees(row_data, target_data, {.rounds = 25, .max_depth = 2});
+    const auto flat = flatten_rows(row_data);
+    std::vector<int> out(row_data.size());
+    ensemble.predict_batch(flat, row_data.front().size(), out);
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        ASSERT_EQ(out[i], ensemble.predict(row_data[i]));
+    }
+    EXPECT_THROW(ensemble.predict_batch(flat, row_data.front().size(), std::span(out).first(10)), std::invalid_argument);
+}
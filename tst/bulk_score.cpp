@@ -0,0 +1,80 @@
+#include "bulk_score.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+namespace
+{
+std::string expected_labels(const std::vector<std::vector<int>> &rows, const Node &tree)
+{
+    std::string out;
+    for (const auto &row : rows)
+    {
+        out += std::to_string(tree_predict(row, tree)) + '\n';
+    }
+    return out;
+}
+} // namespace
+
+TEST(BulkScoreTest, CsvChunksComeBackInOrder)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    // Rows carry the target as an extra column, the second one ends with CRLF and the input has no final newline.
+    std::string csv = "a,b,c,d,e,f,class\n";
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        for (int v : row_data[i])
+        {
+            csv += std::to_string(v) + ',';
+        }
+        csv += std::to_string(target_data[i]) + (i == 1 ? "\r\n" : "\n");
+    }
+    csv.pop_back();
+
+    ThreadPool pool(3);
+    for (size_t chunk_bytes : {size_t{1}, size_t{37}, size_t{4096}, size_t{1} << 22})
+    {
+        std::ostringstream out;
+        const auto rows = bulk_score(csv, tree, out, pool, {.skip_header = true, .chunk_bytes = chunk_bytes, .window = 4});
+        EXPECT_EQ(rows, row_data.size());
+        EXPECT_EQ(out.str(), expected_labels(row_data, tree));
+    }
+}
+
+TEST(BulkScoreTest, BinaryRows)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    std::vector<int> flat;
+    for (const auto &row : row_data)
+    {
+        flat.insert(flat.end(), row.begin(), row.end());
+    }
+    const std::string_view bytes(reinterpret_cast<const char *>(flat.data()), flat.size() * sizeof(int));
+
+    ThreadPool pool(2);
+    std::ostringstream out;
+    EXPECT_EQ(bulk_score(bytes, tree, out, pool, {.format = InputFormat::Binary, .width = 6, .chunk_bytes = 1000}), row_data.size());
+    EXPECT_EQ(out.str(), expected_labels(row_data, tree));
+
+    std::ostringstream ignored;
+    EXPECT_THROW(bulk_score(bytes.substr(4), tree, ignored, pool, {.format = InputFormat::Binary, .width = 6}), std::runtime_error);
+    EXPECT_THROW(bulk_score(bytes, tree, ignored, pool, {.format = InputFormat::Binary}), std::invalid_argument);
+}
+
+TEST(BulkScoreTest, MalformedCsv)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    ThreadPool pool(2);
+    std::ostringstream out;
+    EXPECT_THROW(bulk_score("0,0,0,0,0,0\n0,0,x,0,0,0\n", tree, out, pool), std::runtime_error);
+    EXPECT_THROW(bulk_score("0,0,0,0,0,0\n0,0,0\n", tree, out, pool, {.chunk_bytes = 1}), std::runtime_error);
+    EXPECT_THROW(bulk_score("0,0,0,0,0,0\n", tree, out, pool, {.width = 2}), std::invalid_argument);
+}
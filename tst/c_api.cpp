@@ -0,0 +1,87 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include "tree_race.h"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+TEST(CApiTest, TrainsAndPredictsOnCallerMemory)
+{
+    auto [row_data, target_data] = load_car_data();
+    const size_t width = row_data[0].size();
+    std::vector<int32_t> row_major;
+    for (const auto &row : row_data)
+    {
+        row_major.insert(row_major.end(), row.begin(), row.end());
+    }
+    std::vector<tr_column> cols(width);
+    for (size_t j = 0; j < width; ++j)
+    {
+        cols[j] = {row_major.data() + j, width};
+    }
+
+    tr_build_options options;
+    tr_build_options_init(&options);
+    options.criterion = TR_GINI;
+    options.min_samples_split = 10;
+
+    tr_tree *tree = nullptr;
+    ASSERT_EQ(tr_build_tree(cols.data(), width, {target_data.data(), 1}, row_data.size(), &options, &tree), TR_OK);
+    ASSERT_NE(tree, nullptr);
+
+    const auto expected = build_tree<Gini>(row_data, target_data, 10);
+    EXPECT_EQ(tr_tree_input_width(tree), tree_input_width(expected));
+
+    std::vector<int32_t> out(row_data.size());
+    ASSERT_EQ(tr_predict(tree, cols.data(), width, row_data.size(), out.data()), TR_OK);
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        EXPECT_EQ(out[i], tree_predict(row_data[i], expected));
+    }
+
+    const auto path = (std::filesystem::temp_directory_path() / "tree_race_c_api_test").string();
+    ASSERT_EQ(tr_save_tree(tree, path.c_str()), TR_OK);
+    tr_tree *loaded = nullptr;
+    ASSERT_EQ(tr_load_tree(path.c_str(), &loaded), TR_OK);
+    std::vector<int32_t> loaded_out(row_data.size());
+    ASSERT_EQ(tr_predict(loaded, cols.data(), width, row_data.size(), loaded_out.data()), TR_OK);
+    EXPECT_EQ(loaded_out, out);
+    std::filesystem::remove(path);
+
+    tr_free_tree(loaded);
+    tr_free_tree(tree);
+    tr_free_tree(nullptr);
+}
+
+TEST(CApiTest, ReportsErrors)
+{
+    auto [row_data, target_data] = load_tennis_data();
+    std::vector<int32_t> col(row_data.size());
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        col[i] = row_data[i][0];
+    }
+    const tr_column column{col.data(), 1};
+
+    tr_tree *tree = nullptr;
+    EXPECT_EQ(tr_build_tree(&column, 1, {nullptr, 1}, col.size(), nullptr, &tree), TR_INVALID_ARGUMENT);
+    EXPECT_STREQ(tr_last_error(), "target data is null");
+
+    tr_build_options options;
+    tr_build_options_init(&options);
+    options.criterion = static_cast<tr_criterion>(7);
+    EXPECT_EQ(tr_build_tree(&column, 1, {target_data.data(), 1}, col.size(), &options, &tree), TR_INVALID_ARGUMENT);
+
+    col[3] = -1;
+    EXPECT_EQ(tr_build_tree(&column, 1, {target_data.data(), 1}, col.size(), nullptr, &tree), TR_INVALID_ARGUMENT);
+    EXPECT_STREQ(tr_last_error(), "negative categorical value");
+    EXPECT_EQ(tree, nullptr);
+
+    col[3] = 0;
+    ASSERT_EQ(tr_build_tree(&column, 1, {target_data.data(), 1}, col.size(), nullptr, &tree), TR_OK);
+    std::vector<int32_t> out(col.size());
+    EXPECT_EQ(tr_predict(tree, &column, 0, col.size(), out.data()), tr_tree_input_width(tree) > 0 ? TR_INVALID_ARGUMENT : TR_OK);
+    tr_free_tree(tree);
+
+    EXPECT_EQ(tr_load_tree("/nonexistent/tree", &tree), TR_ERROR);
+}
@@ -18,7 +18,7 @@ TEST(CarTest, AllInSample)
         target_data.push_back(class_);
     }
 
-    // Dataset dataset(std::make_shared<InnerDataset>(row_data, target_data));
+    // TrainingContext ctx(row_data, target_data);
 
     const auto tree = build_tree(row_data, target_data);
 
@@ -0,0 +1,118 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+TEST(TrainingContextTest, ReuseMatchesFreshBuild)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    TrainingContext ctx;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto [train_set, _] = train_test_split(row_data, target_data, 0.7);
+        auto &[train_data, train_target] = train_set;
+
+        ctx.assign(train_data, train_target);
+
+        EXPECT_EQ(build_tree(ctx), build_tree(train_data, train_target));
+        EXPECT_EQ(build_tree(ctx, 20), build_tree(train_data, train_target, 20));
+    }
+}
+
+TEST(TrainingContextTest, SelectMatchesMaterializedSample)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    TrainingContext ctx(row_data, target_data);
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(row_data.size()) - 1);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        std::vector<int> sample(row_data.size());
+        std::vector<std::vector<int>> sample_rows;
+        std::vector<int> sample_target;
+        for (auto &idx : sample)
+        {
+            idx = dist(gen);
+            sample_rows.push_back(row_data[idx]);
+            sample_target.push_back(target_data[idx]);
+        }
+
+        ctx.select(sample);
+
+        EXPECT_EQ(build_tree(ctx), build_tree(sample_rows, sample_target));
+    }
+
+    ctx.select_all();
+    EXPECT_EQ(build_tree(ctx), build_tree(row_data, target_data));
+}
+
+TEST(TrainingContextTest, LocalCopiesBuildTheSameTree)
+{
+    auto [row_data, target_data] = load_car_data();
+    std::vector<int> weights(row_data.size());
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        weights[i] = static_cast<int>(i % 3);
+    }
+
+    TrainingContext ctx(row_data, target_data);
+    for (const size_t threshold : {size_t{50}, size_t{400}, row_data.size()})
+    {
+        BuildStats local_stats;
+        BuildStats stats;
+        ctx.set_weights(std::vector<int>(row_data.size(), 1));
+        EXPECT_EQ(build_tree(ctx, {.stats = &local_stats, .local_threshold = threshold}), build_tree(ctx, {.stats = &stats, .local_threshold = 0}));
+        EXPECT_EQ(local_stats.nodes, stats.nodes);
+        EXPECT_EQ(local_stats.early_exits, stats.early_exits);
+        EXPECT_EQ(build_tree<GainRatio>(ctx, {.local_threshold = threshold}), build_tree<GainRatio>(ctx, {.local_threshold = 0}));
+
+        ctx.set_weights(weights);
+        EXPECT_EQ(build_tree<Gini>(ctx, {.local_threshold = threshold}), build_tree<Gini>(ctx, {.local_threshold = 0}));
+    }
+}
+
+TEST(TrainingContextTest, ColumnsInCallerMemory)
+{
+    auto [row_data, target_data] = load_car_data();
+    const size_t width = row_data[0].size();
+    const auto row_major = [&]
+    {
+        std::vector<int> flat;
+        for (const auto &row : row_data)
+        {
+            flat.insert(flat.end(), row.begin(), row.end());
+        }
+        return flat;
+    }();
+    std::vector<std::vector<int>> col_major(width);
+    for (const auto &row : row_data)
+    {
+        for (size_t j = 0; j < width; ++j)
+        {
+            col_major[j].push_back(row[j]);
+        }
+    }
+
+    std::vector<StridedColumn> strided(width);
+    std::vector<StridedColumn> contiguous(width);
+    for (size_t j = 0; j < width; ++j)
+    {
+        strided[j] = {row_major.data() + j, width};
+        contiguous[j] = {col_major[j].data()};
+    }
+
+    for (const std::bitset<64> numeric : {std::bitset<64>{}, std::bitset<64>{0b100001}})
+    {
+        TrainingContext copy(row_data, target_data, numeric);
+        const auto expected = build_tree(copy);
+
+        TrainingContext ctx;
+        ctx.assign_columns(strided, {target_data.data()}, row_data.size(), numeric);
+        EXPECT_EQ(build_tree(ctx), expected);
+        ctx.assign_columns(contiguous, {target_data.data()}, row_data.size(), numeric);
+        EXPECT_EQ(build_tree(ctx), expected);
+    }
+}
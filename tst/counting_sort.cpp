@@ -0,0 +1,36 @@
+#include "counting_sort.hpp"
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST(CountingSortTest, InterleavedMatchesScalar)
+{
+    std::mt19937 gen(6);
+    for (const int cardinality : {1, 2, 5, 31, 32, 100})
+    {
+        for (const size_t n : {0, 1, 7, 63, 64, 65, 66, 67, 1000, 4099})
+        {
+            std::vector<int> col_data(n * 2 + 1);
+            for (auto &v : col_data)
+            {
+                v = static_cast<int>(gen() % static_cast<unsigned>(cardinality));
+            }
+            std::vector<int> rows(col_data.size());
+            std::iota(rows.begin(), rows.end(), 0);
+            std::shuffle(rows.begin(), rows.end(), gen);
+            rows.resize(n);
+
+            std::vector<int> count(counting_sort_lanes * static_cast<size_t>(cardinality)), keys(n), output(n);
+            auto expected = rows;
+            counting_sort_scalar(col_data.data(), expected.data(), n, count.data(), output.data());
+            ASSERT_TRUE(std::ranges::is_sorted(expected, {}, [&](int idx) { return col_data[idx]; }));
+
+            auto sorted = rows;
+            counting_sort_interleaved(col_data.data(), sorted.data(), n, count.data(), keys.data(), output.data());
+            EXPECT_EQ(sorted, expected) << cardinality << " keys, " << n << " rows";
+            EXPECT_TRUE(std::ranges::all_of(count, [](int c) { return c == 0; }));
+        }
+    }
+}
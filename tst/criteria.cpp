@@ -0,0 +1,43 @@
+#include "criteria.hpp"
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+TEST(CriteriaTest, PartitionImpurity)
+{
+    const std::vector<int> pure = {0, 4, 0};
+    const std::vector<int> even = {2, 2, 0};
+
+    EXPECT_FLOAT_EQ(Entropy::impurity(4, pure), 0);
+    EXPECT_FLOAT_EQ(Entropy::impurity(4, even), 4 * std::log(2.0F));
+    EXPECT_FLOAT_EQ(Gini::impurity(4, pure), 0);
+    EXPECT_FLOAT_EQ(Gini::impurity(4, even), 2);
+}
+
+TEST(CriteriaTest, EntropyIsDefault)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    EXPECT_EQ(build_tree<Entropy>(row_data, target_data), build_tree(row_data, target_data));
+}
+
+template <typename Criterion>
+class CriterionTest : public testing::Test
+{
+};
+
+using AllCriteria = testing::Types<Entropy, GainRatio, Gini>;
+TYPED_TEST_SUITE(CriterionTest, AllCriteria);
+
+TYPED_TEST(CriterionTest, AllInSample)
+{
+    for (const auto &[row_data, target_data] : {load_car_data(), load_tennis_data()})
+    {
+        const auto tree = build_tree<TypeParam>(row_data, target_data);
+
+        for (size_t i = 0; i < row_data.size(); ++i)
+        {
+            EXPECT_EQ(tree_predict(row_data[i], tree), target_data[i]);
+        }
+    }
+}
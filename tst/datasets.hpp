@@ -0,0 +1,44 @@
+#pragma once
+
+#include "csv.h"
+
+#include <utility>
+#include <vector>
+
+inline std::pair<std::vector<std::vector<int>>, std::vector<int>> load_car_data()
+{
+    constexpr int cols = 7;
+
+    io::CSVReader<cols> in("../datasets/car_eval.csv");
+    int buying, maint, doors, person, lug_boot, safety, class_;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(buying, maint, doors, person, lug_boot, safety, class_))
+    {
+        row_data.push_back({buying, maint, doors, person, lug_boot, safety});
+        target_data.push_back(class_);
+    }
+
+    return {row_data, target_data};
+}
+
+inline std::pair<std::vector<std::vector<int>>, std::vector<int>> load_tennis_data()
+{
+    constexpr int cols = 5;
+
+    io::CSVReader<cols> in("../datasets/tennis.csv");
+    int outlook, temp, humidity, wind, play;
+
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+
+    while (in.read_row(outlook, temp, humidity, wind, play))
+    {
+        row_data.push_back({outlook, temp, humidity, wind});
+        target_data.push_back(play);
+    }
+
+    return {row_data, target_data};
+}
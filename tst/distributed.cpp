@@ -0,0 +1,74 @@
+#include "datasets.hpp"
+#include "distributed.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+TEST(DistributedTest, MatchesSingleProcessBuild)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    for (const int workers : {1, 3})
+    {
+        EXPECT_EQ(build_tree_forked(row_data, target_data, workers), build_tree(row_data, target_data)) << workers << " workers";
+        EXPECT_EQ(build_tree_forked<Gini>(row_data, target_data, workers, {.min_samples_split = 20, .max_depth = 3}),
+                  build_tree<Gini>(row_data, target_data, {.min_samples_split = 20, .max_depth = 3}))
+            << workers << " workers";
+        EXPECT_EQ(build_tree_forked<GainRatio>(row_data, target_data, workers), build_tree<GainRatio>(row_data, target_data)) << workers << " workers";
+    }
+}
+
+TEST(DistributedTest, UnevenShards)
+{
+    std::mt19937 gen(46);
+    std::vector<std::vector<int>> row_data(500, std::vector<int>(6));
+    std::vector<int> target_data(row_data.size());
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        for (auto &v : row_data[i])
+        {
+            v = static_cast<int>(gen() % 5);
+        }
+        target_data[i] = (row_data[i][0] + row_data[i][2] * row_data[i][4] + static_cast<int>(gen() % 2)) % 4;
+    }
+    const auto expected = build_tree(row_data, target_data);
+
+    // The second worker holds no rows at all, and the first holds fewer rows than there are workers.
+    const std::vector<size_t> bounds = {0, 2, 2, 180, row_data.size()};
+    const auto tree = fork_workers(4,
+                                   [&](int rank, ReductionTransport &transport)
+                                   {
+                                       const auto begin = row_data.begin() + static_cast<std::ptrdiff_t>(bounds[static_cast<size_t>(rank)]);
+                                       const auto end = row_data.begin() + static_cast<std::ptrdiff_t>(bounds[static_cast<size_t>(rank) + 1]);
+                                       const std::vector<std::vector<int>> rows(begin, end);
+                                       const std::vector<int> target(target_data.begin() + (begin - row_data.begin()),
+                                                                     target_data.begin() + (end - row_data.begin()));
+                                       return build_tree_sharded(rows, target, transport);
+                                   });
+    EXPECT_EQ(tree, expected);
+
+    const std::vector<std::vector<int>> no_rows;
+    EXPECT_EQ(build_tree_forked(no_rows, {}, 2), build_tree(no_rows, {}));
+}
+
+TEST(DistributedTest, FailedWorkerIsReported)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    // A worker that gives up mid-build leaves the others with a hung-up peer instead of blocking them.
+    const auto fail_rank = [&](int failing)
+    {
+        return fork_workers(3,
+                            [&](int rank, ReductionTransport &transport)
+                            {
+                                if (rank == failing)
+                                    throw std::runtime_error("worker failed");
+                                return build_tree_sharded(row_data, target_data, transport);
+                            });
+    };
+    EXPECT_THROW(fail_rank(0), std::runtime_error);
+    EXPECT_THROW(fail_rank(2), std::runtime_error);
+
+    EXPECT_THROW(build_tree_forked(row_data, target_data, 0), std::invalid_argument);
+}
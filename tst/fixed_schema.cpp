@@ -0,0 +1,46 @@
+#include "datasets.hpp"
+#include "fixed_schema.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+TEST(FixedSchemaTest, MatchesGenericBuild)
+{
+    auto [car_rows, car_target] = load_car_data();
+    EXPECT_EQ((build_tree<6, 3, 4>(car_rows, car_target)), build_tree(car_rows, car_target));
+    EXPECT_EQ((build_tree<6, 3, 4>(car_rows, car_target, 30)), build_tree(car_rows, car_target, 30));
+    EXPECT_EQ((build_tree<6, 3, 4, Gini>(car_rows, car_target, {.max_depth = 3})), build_tree<Gini>(car_rows, car_target, {.max_depth = 3}));
+    EXPECT_EQ((build_tree<6, 3, 4, GainRatio>(car_rows, car_target)), build_tree<GainRatio>(car_rows, car_target));
+
+    // A wider schema than the data needs builds the same tree.
+    auto [tennis_rows, tennis_target] = load_tennis_data();
+    EXPECT_EQ((build_tree<4, 2, 2>(tennis_rows, tennis_target)), build_tree(tennis_rows, tennis_target));
+    EXPECT_EQ((build_tree<4, 7, 5>(tennis_rows, tennis_target)), build_tree(tennis_rows, tennis_target));
+
+    // Small retraining samples, one builder reused.
+    std::mt19937 gen(12);
+    FixedSchemaBuilder<6, 3, 4> builder;
+    for (int model = 0; model < 20; ++model)
+    {
+        std::vector<std::vector<int>> rows;
+        std::vector<int> target;
+        for (int i = 0; i < 150; ++i)
+        {
+            const auto row = gen() % car_rows.size();
+            rows.push_back(car_rows[row]);
+            target.push_back(car_target[row]);
+        }
+        ASSERT_EQ(builder.build(rows, target), build_tree(rows, target));
+    }
+}
+
+TEST(FixedSchemaTest, RejectsDataOutsideSchema)
+{
+    auto [car_rows, car_target] = load_car_data();
+    EXPECT_TRUE((FixedSchemaBuilder<6, 3, 4>::fits(car_rows, car_target)));
+    EXPECT_FALSE((FixedSchemaBuilder<6, 2, 4>::fits(car_rows, car_target)));
+    EXPECT_FALSE((FixedSchemaBuilder<6, 3, 3>::fits(car_rows, car_target)));
+    EXPECT_THROW((build_tree<5, 3, 4>(car_rows, car_target)), std::invalid_argument);
+    EXPECT_THROW((build_tree<6, 3, 4>(car_rows, {0, 1})), std::invalid_argument);
+}
@@ -0,0 +1,82 @@
+#include "batch_predict.hpp"
+#include "datasets.hpp"
+#include "hot_path.hpp"
+#include "packed_tree.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+// Car rows with every attribute value shifted to both known values and one the tree never saw.
+std::vector<std::vector<int>> probe_rows(const std::vector<std::vector<int>> &rows)
+{
+    auto probes = rows;
+    for (const auto &row : rows)
+    {
+        for (size_t col = 0; col < row.size(); ++col)
+        {
+            auto probe = row;
+            probe[col] = 7;
+            probes.push_back(std::move(probe));
+        }
+    }
+    return probes;
+}
+} // namespace
+
+TEST(HotPathTest, ReorderKeepsPredictions)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    // Skewed traffic: almost everything has high safety (5th attribute = 2), which most trees split on first.
+    std::vector<std::vector<int>> traffic;
+    for (const auto &row : row_data)
+    {
+        if (row[5] == 2 || traffic.size() % 50 == 0)
+        {
+            traffic.push_back(row);
+        }
+    }
+
+    auto reordered = tree;
+    const auto flat = flatten_rows(traffic);
+    EXPECT_GT(reorder_by_traffic(reordered, flat, 6), 0);
+    EXPECT_NE(reordered, tree);
+    EXPECT_EQ(count_nodes(reordered), count_nodes(tree));
+    EXPECT_EQ(reordered.children().front().inter_label(), 2);
+    EXPECT_EQ(reorder_by_traffic(reordered, flat, 6), 0);
+
+    const PackedTree packed(tree);
+    const PackedTree hot(reordered, PackedLayout::HotPath);
+    const PackedTree hot_bfs(reordered);
+    EXPECT_EQ(hot.num_nodes(), packed.num_nodes());
+    for (const auto &row : probe_rows(row_data))
+    {
+        const auto expected = tree_predict(row, tree);
+        ASSERT_EQ(tree_predict(row, reordered), expected);
+        ASSERT_EQ(packed.predict(row), expected);
+        ASSERT_EQ(hot.predict(row), expected);
+        ASSERT_EQ(hot_bfs.predict(row), expected);
+    }
+
+    EXPECT_THROW(reorder_by_traffic(reordered, flat, 5), std::invalid_argument);
+}
+
+TEST(HotPathTest, FallbackFollowsSmallestValue)
+{
+    auto [row_data, target_data] = load_tennis_data();
+    auto tree = build_tree(row_data, target_data);
+    ASSERT_FALSE(tree.is_leaf());
+    const auto attr = static_cast<size_t>(tree.split_attribute());
+
+    std::ranges::reverse(tree.children());
+    EXPECT_EQ(fallback_child(tree).inter_label(), 0);
+
+    auto unseen = row_data.front();
+    unseen[attr] = 9;
+    auto smallest = row_data.front();
+    smallest[attr] = 0;
+    EXPECT_EQ(tree_predict(unseen, tree), tree_predict(smallest, tree));
+    EXPECT_EQ(PackedTree(tree, PackedLayout::HotPath).predict(unseen), tree_predict(smallest, tree));
+}
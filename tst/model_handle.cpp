@@ -0,0 +1,127 @@
+#include "datasets.hpp"
+#include "model_handle.hpp"
+#include "serve.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+
+namespace
+{
+struct VersionedModel
+{
+    static inline std::atomic<int> live{0};
+
+    std::vector<int> payload;
+    std::atomic<bool> alive{true};
+
+    explicit VersionedModel(int version) : payload(64, version) { ++live; }
+
+    ~VersionedModel()
+    {
+        alive = false;
+        --live;
+    }
+};
+} // namespace
+
+TEST(ModelHandleTest, ReadersNeverSeeReclaimedModels)
+{
+    {
+        ModelHandle<VersionedModel> handle(std::make_unique<const VersionedModel>(0), 8);
+
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r)
+        {
+            readers.emplace_back(
+                [&]
+                {
+                    const auto reader = handle.reader();
+                    int last_version = 0;
+                    while (!done)
+                    {
+                        const auto model = reader.pin();
+                        const int version = model->payload.front();
+                        for (int v : model->payload)
+                        {
+                            torn += v != version || !model->alive;
+                        }
+                        torn += version < last_version;
+                        last_version = version;
+                    }
+                });
+        }
+
+        for (int version = 1; version <= 2000; ++version)
+        {
+            handle.publish(std::make_unique<const VersionedModel>(version));
+        }
+        done = true;
+        for (auto &t : readers)
+        {
+            t.join();
+        }
+
+        EXPECT_EQ(torn, 0);
+        EXPECT_EQ(VersionedModel::live, 1);
+        EXPECT_EQ(handle.reader().pin()->payload.front(), 2000);
+    }
+    EXPECT_EQ(VersionedModel::live, 0);
+}
+
+TEST(ModelHandleTest, ReaderSlotsAreReused)
+{
+    ModelHandle<int> handle(std::make_unique<const int>(1), 2);
+    {
+        auto a = handle.reader();
+        auto b = handle.reader();
+        EXPECT_THROW(handle.reader(), std::runtime_error);
+    }
+    EXPECT_EQ(*handle.reader().pin(), 1);
+}
+
+TEST(PredictionServerTest, PublishesModelsWhileServing)
+{
+    auto [row_data, target_data] = load_car_data();
+    auto [tennis_rows, tennis_target] = load_tennis_data();
+
+    std::vector<Node> models;
+    models.push_back(build_tree(row_data, target_data));
+    const auto car_tree = models[0];
+    const auto tennis_tree = build_tree(tennis_rows, tennis_target);
+
+    PredictionServer server(std::move(models), {.threads = 2, .max_batch = 8, .latency_budget = std::chrono::microseconds(50)});
+    EXPECT_THROW(server.publish_model(2, tennis_tree), std::out_of_range);
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    std::thread serving([&] { server.serve(fds[1], fds[1]); });
+
+    const auto ask = [&](uint16_t model, std::span<const int> obs)
+    {
+        const RequestHeader header{0, model, static_cast<uint16_t>(obs.size())};
+        write_full(fds[0], &header, sizeof(header));
+        write_full(fds[0], obs.data(), obs.size() * sizeof(int));
+        Response response{};
+        read_full(fds[0], &response, sizeof(response));
+        return response.label;
+    };
+
+    EXPECT_EQ(ask(1, tennis_rows[0]), UnknownModel);
+    server.publish_model(1, tennis_tree);
+    EXPECT_EQ(ask(0, row_data[5]), tree_predict(row_data[5], car_tree));
+    for (const auto &row : tennis_rows)
+    {
+        EXPECT_EQ(ask(1, row), tree_predict(row, tennis_tree));
+    }
+
+    server.publish_model(0, tennis_tree);
+    EXPECT_EQ(ask(0, row_data[5]), tree_predict(row_data[5], tennis_tree));
+
+    ::shutdown(fds[0], SHUT_WR);
+    serving.join();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
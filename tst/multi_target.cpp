@@ -0,0 +1,85 @@
+#include "datasets.hpp"
+#include "multi_target.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+// car_eval's label, a noisy copy of it that mostly agrees on the splits, and labels derived from single attributes.
+std::vector<std::vector<int>> related_targets(const std::vector<std::vector<int>> &rows, const std::vector<int> &target)
+{
+    std::mt19937 gen(31);
+    std::vector<std::vector<int>> targets(4);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        targets[0].push_back(target[i]);
+        targets[1].push_back(gen() % 20 == 0 ? static_cast<int>(gen() % 4) : target[i]);
+        targets[2].push_back(rows[i][0] > 1 ? 1 : 0);
+        targets[3].push_back((rows[i][3] + rows[i][5]) % 3);
+    }
+    return targets;
+}
+} // namespace
+
+TEST(MultiTargetTest, MatchesOneBuildPerTarget)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto targets = related_targets(row_data, target_data);
+
+    const auto trees = build_trees(row_data, targets);
+    ASSERT_EQ(trees.size(), targets.size());
+    for (size_t t = 0; t < targets.size(); ++t)
+    {
+        EXPECT_EQ(trees[t], build_tree(row_data, targets[t])) << "target " << t;
+    }
+
+    const auto gini = build_trees<Gini>(row_data, targets, {.min_samples_split = 20, .max_depth = 4});
+    const auto ratio = build_trees<GainRatio>(row_data, targets);
+    for (size_t t = 0; t < targets.size(); ++t)
+    {
+        EXPECT_EQ(gini[t], build_tree<Gini>(row_data, targets[t], {.min_samples_split = 20, .max_depth = 4})) << "target " << t;
+        EXPECT_EQ(ratio[t], build_tree<GainRatio>(row_data, targets[t])) << "target " << t;
+    }
+}
+
+TEST(MultiTargetTest, SelectedAndWeightedRows)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto targets = related_targets(row_data, target_data);
+
+    std::mt19937 gen(32);
+    std::vector<int> sample(800);
+    for (auto &row : sample)
+    {
+        row = static_cast<int>(gen() % row_data.size());
+    }
+    std::vector<int> weights(row_data.size());
+    for (auto &w : weights)
+    {
+        w = static_cast<int>(gen() % 3);
+    }
+
+    TrainingContext ctx(row_data, target_data);
+    ctx.set_weights(weights);
+    ctx.select(sample);
+    const auto trees = build_trees(ctx, targets);
+
+    TrainingContext single;
+    for (size_t t = 0; t < targets.size(); ++t)
+    {
+        single.assign_weighted(row_data, targets[t], weights);
+        single.select(sample);
+        EXPECT_EQ(trees[t], build_tree(single)) << "target " << t;
+    }
+
+    // The context keeps its own labels, selection and weights.
+    single.assign_weighted(row_data, target_data, weights);
+    single.select(sample);
+    EXPECT_EQ(build_tree(ctx), build_tree(single));
+
+    EXPECT_THROW(build_trees(ctx, {{1, 2}}), std::invalid_argument);
+    TrainingContext numeric(row_data, target_data, 0b1);
+    EXPECT_THROW(build_trees(numeric, targets), std::invalid_argument);
+}
@@ -0,0 +1,74 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+TEST(NumericTest, SingleThreshold)
+{
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    for (int price = 0; price < 2'000'000; price += 997)
+    {
+        row_data.push_back({price % 3, price});
+        target_data.push_back(price > 1'234'567);
+    }
+
+    TrainingContext ctx(row_data, target_data, 0b10);
+    const auto tree = build_tree(ctx);
+
+    ASSERT_TRUE(tree.is_threshold());
+    EXPECT_EQ(tree.split_attribute(), 1);
+    EXPECT_EQ(count_nodes(tree), 3);
+    EXPECT_LE(tree.threshold(), 1'234'567);
+    EXPECT_GT(tree.threshold() + 997, 1'234'567);
+
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        EXPECT_EQ(tree_predict(row_data[i], tree), target_data[i]);
+    }
+}
+
+TEST(NumericTest, ReusesAttributeAcrossLevels)
+{
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    for (int x = -50; x < 50; ++x)
+    {
+        row_data.push_back({x});
+        target_data.push_back((x / 10) % 2 != 0);
+    }
+
+    TrainingContext ctx(row_data, target_data, 0b1);
+    const auto tree = build_tree(ctx);
+
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        EXPECT_EQ(tree_predict(row_data[i], tree), target_data[i]);
+    }
+
+    // The presorted orders are restored for every build.
+    EXPECT_EQ(build_tree(ctx), tree);
+}
+
+TEST(NumericTest, MixedCarAllInSample)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    // buying, maint and safety are ordinal, so they work as numeric attributes too.
+    TrainingContext ctx(row_data, target_data, 0b100011);
+    const auto tree = build_tree(ctx, 1);
+
+    for (size_t i = 0; i < row_data.size(); ++i)
+    {
+        EXPECT_EQ(tree_predict(row_data[i], tree), target_data[i]);
+    }
+
+    std::vector<int> sample(row_data.size() / 2);
+    std::iota(sample.begin(), sample.end(), 0);
+    ctx.select(sample);
+
+    std::vector<std::vector<int>> sample_rows(row_data.begin(), row_data.begin() + static_cast<long>(sample.size()));
+    std::vector<int> sample_target(target_data.begin(), target_data.begin() + static_cast<long>(sample.size()));
+    TrainingContext sample_ctx(sample_rows, sample_target, 0b100011);
+
+    EXPECT_EQ(build_tree(ctx), build_tree(sample_ctx));
+}
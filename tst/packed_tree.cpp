@@ -0,0 +1,45 @@
+#include "datasets.hpp"
+#include "packed_tree.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+TEST(PackedTreeTest, PredictsLikeTree)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    for (auto numeric : {std::bitset<64>{}, std::bitset<64>{0b100001}})
+    {
+        TrainingContext ctx(row_data, target_data, numeric);
+        const auto tree = build_tree(ctx);
+        const PackedTree packed(tree);
+
+        EXPECT_EQ(packed.num_nodes(), count_nodes(tree));
+        for (auto row : row_data)
+        {
+            ASSERT_EQ(packed.predict(row), tree_predict(row, tree));
+
+            // Values never seen in training take the same fallback path.
+            row[1] = 9;
+            row[3] = -1;
+            ASSERT_EQ(tree_predict(row, packed), tree_predict(row, tree));
+        }
+    }
+}
+
+TEST(PackedTreeTest, RejectsTreesThatDoNotFit)
+{
+    const auto with_value = [](int value)
+    {
+        auto child = Node::make_leaf(1);
+        child.set_inter_label(value);
+        std::vector<Node> children;
+        children.push_back(child);
+        return Node::make_inter(0, std::move(children));
+    };
+
+    EXPECT_NO_THROW(PackedTree(with_value(255)));
+    EXPECT_THROW(PackedTree(with_value(256)), std::invalid_argument);
+    EXPECT_THROW(PackedTree(with_value(-1)), std::invalid_argument);
+    EXPECT_THROW(PackedTree(Node::make_leaf(1 << 16)), std::invalid_argument);
+    EXPECT_THROW(PackedTree(Node::make_threshold(256, 0, Node::make_leaf(0), Node::make_leaf(1))), std::invalid_argument);
+}
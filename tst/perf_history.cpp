@@ -0,0 +1,84 @@
+#include "perf_history.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+
+TEST(PerfHistoryTest, StudentT)
+{
+    // Two-sided 5% critical values from the t table.
+    EXPECT_NEAR(student_t_two_sided(2.228, 10), 0.05, 1e-4);
+    EXPECT_NEAR(student_t_two_sided(2.262, 9), 0.05, 1e-4);
+    EXPECT_NEAR(student_t_two_sided(1.960, 1e6), 0.05, 1e-4);
+    EXPECT_NEAR(student_t_two_sided(0, 5), 1.0, 1e-12);
+    EXPECT_NEAR(student_t_critical(0.05, 4), 2.776, 1e-3);
+
+    const std::vector<double> values = {10, 12, 11, 13, 9};
+    const auto s = summarize(values);
+    EXPECT_EQ(s.n, 5);
+    EXPECT_DOUBLE_EQ(s.mean, 11);
+    EXPECT_NEAR(s.stddev, std::sqrt(2.5), 1e-12);
+    EXPECT_NEAR(s.ci95, 2.776 * std::sqrt(2.5) / std::sqrt(5.0), 1e-3);
+}
+
+TEST(PerfHistoryTest, ComparisonFlagsOnlyRealChanges)
+{
+    std::mt19937 gen(49);
+    std::normal_distribution<double> noise(0, 0.01);
+    const auto run = [&](const std::string &label, double build_ns, double predict_ns)
+    {
+        std::vector<PerfSample> samples;
+        for (int rep = 0; rep < 10; ++rep)
+        {
+            samples.push_back({label, "BM_BuildTree", build_ns * (1 + noise(gen)), 0});
+            samples.push_back({label, "BM_TreePredict", predict_ns * (1 + noise(gen)), 0});
+        }
+        samples.push_back({label, "BM_NewBenchmark", 1, 0});
+        return samples;
+    };
+
+    const auto base = run("a", 1e6, 1e3);
+    const auto comparisons = compare_runs(base, run("b", 1.1e6, 1e3));
+    ASSERT_EQ(comparisons.size(), 3);
+    EXPECT_EQ(comparisons[0].benchmark, "BM_BuildTree");
+    EXPECT_EQ(comparisons[0].verdict, PerfVerdict::Slower);
+    EXPECT_LT(comparisons[0].p_value, 1e-6);
+    EXPECT_NEAR(comparisons[0].change, 0.1, 0.02);
+    EXPECT_EQ(comparisons[1].verdict, PerfVerdict::Same);
+    // A single repetition cannot be tested.
+    EXPECT_TRUE(std::isnan(comparisons[2].p_value));
+    EXPECT_EQ(comparisons[2].verdict, PerfVerdict::Same);
+
+    EXPECT_EQ(compare_runs(base, run("c", 0.8e6, 1e3))[0].verdict, PerfVerdict::Faster);
+
+    std::ostringstream table;
+    print_comparison(table, comparisons, "a", "b");
+    EXPECT_NE(table.str().find("| BM_BuildTree |"), std::string::npos);
+    EXPECT_NE(table.str().find("**slower**"), std::string::npos);
+}
+
+TEST(PerfHistoryTest, HistoryRoundTrip)
+{
+    const auto path = (std::filesystem::temp_directory_path() / "tree_race_perf_history").string();
+    std::filesystem::remove(path);
+    EXPECT_TRUE(read_history(path).empty());
+
+    const std::vector<PerfSample> first = {{"a1", "BM_BuildTree", 1000.5, 990}, {"a1", "BM_BuildTree/8", 20, 20}};
+    const std::vector<PerfSample> second = {{"b2", "BM_BuildTree", 1100, 1090}};
+    append_history(path, first);
+    append_history(path, second);
+
+    const auto history = read_history(path);
+    ASSERT_EQ(history.size(), 3);
+    EXPECT_EQ(history[1].benchmark, "BM_BuildTree/8");
+    EXPECT_DOUBLE_EQ(history[0].real_ns, 1000.5);
+    EXPECT_EQ(previous_label(history, "b2"), "a1");
+    EXPECT_EQ(previous_label(history, "c3"), "b2");
+
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "broken line\n";
+    }
+    EXPECT_THROW(read_history(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
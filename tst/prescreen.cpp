@@ -0,0 +1,61 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+bool splits_on(const Node &node, int attribute)
+{
+    if (node.is_leaf())
+        return false;
+    if (node.split_attribute() == attribute)
+        return true;
+    return std::ranges::any_of(node.children(), [&](const Node &child) { return splits_on(child, attribute); });
+}
+} // namespace
+
+TEST(PrescreenTest, ConstantAttributesAreNeverSplitOn)
+{
+    auto [row_data, target_data] = load_tennis_data();
+    for (auto &row : row_data)
+    {
+        row.insert(row.begin(), 3);
+    }
+
+    BuildStats stats;
+    const auto tree = build_tree(row_data, target_data, {.stats = &stats});
+    EXPECT_FALSE(splits_on(tree, 0));
+    EXPECT_GT(stats.constant_skips, 0);
+    EXPECT_EQ(stats.nodes, count_nodes(tree));
+
+    // Rows that agree on every attribute but not on the label cannot be split at all.
+    const auto leaf = build_tree({{1, 2}, {1, 2}, {1, 2}}, {0, 1, 1});
+    EXPECT_TRUE(leaf.is_leaf());
+    EXPECT_EQ(leaf.leaf_label(), 1);
+}
+
+TEST(PrescreenTest, SplitScoreStopsAtBound)
+{
+    auto [row_data, target_data] = load_car_data();
+    TrainingContext ctx(row_data, target_data);
+    auto ds = ctx.begin_build();
+    ds.sort_by(0);
+
+    const float exact = split_score<Entropy>(ds, 0);
+    EXPECT_EQ(split_score<Entropy>(ds, 0, 0, exact + 1), exact);
+    EXPECT_TRUE(std::isinf(split_score<Entropy>(ds, 0, 0, exact / 2)));
+    EXPECT_TRUE(std::isinf(split_score<Gini>(ds, 0, 0, 1)));
+    EXPECT_FALSE(std::isinf(split_score<GainRatio>(ds, 0, 0, -1)));
+}
+
+TEST(PrescreenTest, StatsAddUp)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    BuildStats stats;
+    const auto tree = build_tree(row_data, target_data, {.stats = &stats});
+    EXPECT_EQ(tree, build_tree(row_data, target_data));
+    EXPECT_EQ(stats.nodes, count_nodes(tree));
+    EXPECT_GT(stats.early_exits, 0);
+    EXPECT_LE(stats.constant_skips + stats.early_exits + stats.sample_skips, stats.evaluations);
+}
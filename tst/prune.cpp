@@ -0,0 +1,110 @@
+#include "datasets.hpp"
+#include "prune.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+// car_eval with 15% of the labels replaced, split 70/30 into training and held-out row indices.
+struct NoisyCar
+{
+    std::vector<std::vector<int>> row_data;
+    std::vector<int> target_data;
+    std::vector<int> train;
+    std::vector<int> holdout;
+
+    NoisyCar()
+    {
+        std::tie(row_data, target_data) = load_car_data();
+
+        std::mt19937 gen(11);
+        std::uniform_real_distribution<float> coin(0, 1);
+        for (auto &t : target_data)
+        {
+            if (coin(gen) < 0.15F)
+            {
+                t = static_cast<int>(gen() % 4);
+            }
+        }
+
+        std::vector<int> idx(row_data.size());
+        std::iota(idx.begin(), idx.end(), 0);
+        std::shuffle(idx.begin(), idx.end(), gen);
+        const auto ntrain = static_cast<long>(idx.size() * 7 / 10);
+        train.assign(idx.begin(), idx.begin() + ntrain);
+        holdout.assign(idx.begin() + ntrain, idx.end());
+    }
+
+    int errors(const Node &tree, std::span<const int> rows) const
+    {
+        int errs = 0;
+        for (int row : rows)
+        {
+            errs += tree_predict(row_data[row], tree) != target_data[row];
+        }
+        return errs;
+    }
+};
+
+} // namespace
+
+TEST(PruneTest, StatsRecorded)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto tree = build_tree(row_data, target_data);
+
+    EXPECT_EQ(tree.stats().num_samples, row_data.size());
+
+    int child_samples = 0;
+    for (const auto &child : tree.children())
+    {
+        child_samples += child.stats().num_samples;
+    }
+    EXPECT_EQ(child_samples, row_data.size());
+}
+
+TEST(PruneTest, ReducedErrorNeverHurtsHoldout)
+{
+    NoisyCar data;
+    TrainingContext ctx(data.row_data, data.target_data);
+    ctx.select(data.train);
+
+    auto tree = build_tree(ctx);
+    const int errors_before = data.errors(tree, data.holdout);
+
+    const auto report = prune_reduced_error(tree, ctx, data.holdout);
+
+    EXPECT_LE(data.errors(tree, data.holdout), errors_before);
+    EXPECT_LT(report.nodes_after, report.nodes_before);
+    EXPECT_LE(report.depth_after, report.depth_before);
+    EXPECT_EQ(report.nodes_after, count_nodes(tree));
+}
+
+TEST(PruneTest, CostComplexityShrinksWithAlpha)
+{
+    NoisyCar data;
+    TrainingContext ctx(data.row_data, data.target_data);
+    ctx.select(data.train);
+
+    const auto full = build_tree(ctx);
+
+    auto zero = full;
+    prune_cost_complexity(zero, 0);
+    EXPECT_EQ(data.errors(zero, data.train), data.errors(full, data.train));
+
+    size_t prev_nodes = count_nodes(zero);
+    for (double alpha : {0.0005, 0.002, 0.01, 0.05})
+    {
+        auto tree = full;
+        const auto report = prune_cost_complexity(tree, alpha);
+        EXPECT_LE(report.nodes_after, prev_nodes);
+        prev_nodes = report.nodes_after;
+    }
+
+    auto stump = full;
+    const auto report = prune_cost_complexity(stump, 1);
+    EXPECT_EQ(report.nodes_after, 1);
+    EXPECT_EQ(report.depth_after, 0);
+    EXPECT_EQ(stump.leaf_label(), full.stats().mode_label);
+}
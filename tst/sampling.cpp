@@ -0,0 +1,58 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+// The target follows attribute 2, then attribute 5, with 5% of the labels scrambled; the other attributes are noise.
+std::pair<std::vector<std::vector<int>>, std::vector<int>> make_signal_data(size_t rows)
+{
+    std::mt19937 gen(5);
+    std::vector<std::vector<int>> row_data(rows, std::vector<int>(8));
+    std::vector<int> target(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (auto &v : row_data[i])
+        {
+            v = static_cast<int>(gen() % 5);
+        }
+        target[i] = gen() % 20 == 0 ? static_cast<int>(gen() % 3) : (row_data[i][2] + (row_data[i][5] > 2)) % 3;
+    }
+    return {row_data, target};
+}
+} // namespace
+
+TEST(SamplingTest, ClearWinnerLeavesOneCandidate)
+{
+    auto [row_data, target_data] = make_signal_data(50'000);
+    TrainingContext ctx(row_data, target_data);
+    auto ds = ctx.begin_build();
+
+    const auto candidates = sampled_candidates<Entropy>(ds, 0xFF, {.sample_threshold = 1, .sample_size = 2000});
+    EXPECT_EQ(candidates.count(), 1);
+    EXPECT_TRUE(candidates.test(2));
+
+    // Gain ratio has no bounded score, so nothing can be ruled out.
+    EXPECT_EQ(sampled_candidates<GainRatio>(ds, 0xFF, {.sample_threshold = 1, .sample_size = 2000}), 0xFF);
+}
+
+TEST(SamplingTest, BuildsTheExactTree)
+{
+    auto [row_data, target_data] = make_signal_data(100'000);
+    const BuildOptions sampled{.min_samples_split = 50, .sample_threshold = 5000, .sample_size = 2000};
+    EXPECT_EQ(build_tree(row_data, target_data, sampled), build_tree(row_data, target_data, 50));
+    EXPECT_EQ(build_tree<Gini>(row_data, target_data, sampled), build_tree<Gini>(row_data, target_data, 50));
+
+    // Close candidates fall back to exact scoring.
+    auto [car_rows, car_target] = load_car_data();
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    for (int copy = 0; copy < 20; ++copy)
+    {
+        rows.insert(rows.end(), car_rows.begin(), car_rows.end());
+        target.insert(target.end(), car_target.begin(), car_target.end());
+    }
+    EXPECT_EQ(build_tree(rows, target, {.sample_threshold = 2000, .sample_size = 1000}), build_tree(rows, target));
+}
@@ -0,0 +1,109 @@
+#include "datasets.hpp"
+#include "serialize.hpp"
+#include "serve.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <sys/socket.h>
+
+TEST(SerializeTest, RoundTrip)
+{
+    auto [row_data, target_data] = load_car_data();
+
+    TrainingContext ctx(row_data, target_data, 0b100001);
+    const auto tree = build_tree(ctx);
+
+    std::stringstream buf;
+    save_tree(tree, buf);
+    EXPECT_EQ(load_tree(buf), tree);
+
+    std::stringstream truncated(buf.str().substr(0, buf.str().size() / 2));
+    EXPECT_THROW(load_tree(truncated), std::runtime_error);
+
+    std::stringstream garbage("not a model");
+    EXPECT_THROW(load_tree(garbage), std::runtime_error);
+}
+
+TEST(LatencyHistogramTest, Percentiles)
+{
+    LatencyHistogram hist;
+    for (int us = 1; us <= 1000; ++us)
+    {
+        hist.record(std::chrono::microseconds(us));
+    }
+
+    EXPECT_EQ(hist.count(), 1000);
+    EXPECT_NEAR(static_cast<double>(hist.percentile(0.5).count()), 500e3, 500e3 / 8);
+    EXPECT_NEAR(static_cast<double>(hist.percentile(0.99).count()), 990e3, 990e3 / 8);
+    EXPECT_GE(hist.percentile(1.0), std::chrono::microseconds(1000));
+}
+
+TEST(PredictionServerTest, AnswersEveryRequest)
+{
+    auto [row_data, target_data] = load_car_data();
+    auto [tennis_rows, tennis_target] = load_tennis_data();
+
+    std::vector<Node> models;
+    models.push_back(build_tree(row_data, target_data));
+    models.push_back(build_tree(tennis_rows, tennis_target));
+    const auto car_tree = models[0];
+    const auto tennis_tree = models[1];
+
+    PredictionServer server(std::move(models), {.threads = 3, .max_batch = 16, .latency_budget = std::chrono::microseconds(50)});
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::thread serving([&] { server.serve(fds[1], fds[1]); });
+
+    std::vector<int> expected;
+    std::thread client(
+        [&]
+        {
+            std::vector<char> frames;
+            const auto send = [&](uint16_t model, std::span<const int> obs)
+            {
+                const RequestHeader header{static_cast<uint32_t>(expected.size()), model, static_cast<uint16_t>(obs.size())};
+                frames.insert(frames.end(), reinterpret_cast<const char *>(&header), reinterpret_cast<const char *>(&header + 1));
+                frames.insert(frames.end(), reinterpret_cast<const char *>(obs.data()), reinterpret_cast<const char *>(obs.data() + obs.size()));
+            };
+
+            for (size_t i = 0; i < row_data.size(); ++i)
+            {
+                send(0, row_data[i]);
+                expected.push_back(tree_predict(row_data[i], car_tree));
+                const auto &t = tennis_rows[i % tennis_rows.size()];
+                send(1, t);
+                expected.push_back(tree_predict(t, tennis_tree));
+            }
+            send(7, row_data[0]);
+            expected.push_back(UnknownModel);
+            send(0, std::span(row_data[0]).first(2));
+            expected.push_back(ShortObservation);
+
+            write_full(fds[0], frames.data(), frames.size());
+            ::shutdown(fds[0], SHUT_WR);
+        });
+    client.join();
+
+    std::vector<int> got(expected.size(), 1000);
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        Response resp{};
+        ASSERT_TRUE(read_full(fds[0], &resp, sizeof(resp)));
+        ASSERT_LT(resp.id, got.size());
+        got[resp.id] = resp.label;
+    }
+    serving.join();
+
+    EXPECT_EQ(got, expected);
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.requests, expected.size());
+    EXPECT_GE(stats.batches, expected.size() / 16);
+    EXPECT_LE(stats.p50, stats.p99);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
@@ -0,0 +1,91 @@
+#include "datasets.hpp"
+#include "shared_table.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <sys/wait.h>
+
+namespace
+{
+std::string table_path(const char *name) { return (std::filesystem::temp_directory_path() / name).string(); }
+} // namespace
+
+TEST(SharedTableTest, AttachedContextBuildsTheSameTree)
+{
+    auto [row_data, target_data] = load_car_data();
+    const auto path = table_path("tree_race_shared_table_test");
+
+    for (const std::bitset<64> numeric : {std::bitset<64>{}, std::bitset<64>{0b100001}})
+    {
+        publish_table(path, row_data, target_data, numeric);
+        TrainingContext ctx;
+        attach(ctx, SharedTable::open(path));
+        ASSERT_EQ(ctx.num_rows(), row_data.size());
+
+        TrainingContext copy(row_data, target_data, numeric);
+        EXPECT_EQ(build_tree(ctx), build_tree(copy));
+        EXPECT_EQ(build_tree<Gini>(ctx, 20), build_tree<Gini>(copy, 20));
+
+        std::vector<int> sample(400);
+        for (size_t i = 0; i < sample.size(); ++i)
+        {
+            sample[i] = static_cast<int>(i * 7 % row_data.size());
+        }
+        ctx.select(sample);
+        copy.select(sample);
+        EXPECT_EQ(build_tree(ctx), build_tree(copy));
+    }
+
+    // A forked trainer attaches on its own and sees the same table.
+    publish_table(path, row_data, target_data);
+    const auto expected = build_tree(row_data, target_data);
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        TrainingContext ctx;
+        attach(ctx, SharedTable::open(path));
+        ::_exit(build_tree(ctx) == expected ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::filesystem::remove(path);
+}
+
+TEST(SharedTableTest, ContextKeepsTheMappingAlive)
+{
+    auto [row_data, target_data] = load_tennis_data();
+    const auto path = table_path("tree_race_shared_table_alive");
+    publish_table(path, row_data, target_data);
+
+    TrainingContext ctx;
+    attach(ctx, SharedTable::open(path));
+    std::filesystem::remove(path);
+    EXPECT_EQ(build_tree(ctx), build_tree(row_data, target_data));
+
+    // Reassigning drops the mapping and trains on the context's own copy again.
+    ctx.assign(row_data, target_data);
+    EXPECT_EQ(build_tree(ctx), build_tree(row_data, target_data));
+}
+
+TEST(SharedTableTest, RejectsBadFiles)
+{
+    auto [row_data, target_data] = load_tennis_data();
+    const auto path = table_path("tree_race_shared_table_bad");
+
+    EXPECT_THROW(SharedTable::open(path + ".missing"), std::runtime_error);
+
+    publish_table(path, row_data, target_data);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_THROW(SharedTable::open(path), std::runtime_error);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a table at all, but long enough to hold a header";
+    }
+    EXPECT_THROW(SharedTable::open(path), std::runtime_error);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,51 @@
+#include "datasets.hpp"
+#include "sweep.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <random>
+
+TEST(SweepTest, TruncationMatchesRebuild)
+{
+    auto [row_data, target_data] = load_car_data();
+    std::mt19937 gen(21);
+    for (auto &t : target_data)
+    {
+        if (gen() % 10 == 0)
+        {
+            t = static_cast<int>(gen() % 4);
+        }
+    }
+
+    std::vector<int> rows(row_data.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::shuffle(rows.begin(), rows.end(), gen);
+    const std::span<const int> train(rows.data(), 1200);
+    const auto validation = std::span<const int>(rows).subspan(1200);
+
+    TrainingContext ctx(row_data, target_data);
+    ctx.select(train);
+
+    const std::vector<SweepConfig> configs{{2}, {5}, {20}, {100}, {2, 2}, {10, 4}, {1200}};
+    const auto sweep = sweep_tree(ctx, configs, validation);
+    ASSERT_EQ(sweep.results.size(), configs.size());
+    EXPECT_EQ(sweep.tree, build_tree(ctx));
+
+    for (const auto &result : sweep.results)
+    {
+        const auto &config = result.config;
+        const auto tree = build_tree(ctx, {.min_samples_split = config.min_samples_split, .max_depth = config.max_depth});
+        EXPECT_EQ(truncate_tree(sweep.tree, config), tree);
+        EXPECT_EQ(result.nodes, count_nodes(tree));
+
+        int errors = 0;
+        for (const int row : validation)
+        {
+            errors += tree_predict(row_data[static_cast<size_t>(row)], tree) != target_data[static_cast<size_t>(row)];
+        }
+        EXPECT_EQ(result.errors, errors);
+    }
+    EXPECT_EQ(sweep.results.back().nodes, 1);
+    EXPECT_THROW(sweep_tree(ctx, {}, validation), std::invalid_argument);
+}
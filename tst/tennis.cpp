@@ -19,7 +19,7 @@ TEST(TennisTest, AllInSample)
         target_data.push_back(play);
     }
 
-    // Dataset dataset(std::make_shared<InnerDataset>(row_data, target_data));
+    // TrainingContext ctx(row_data, target_data);
 
     const auto tree = build_tree(row_data, target_data);
 
@@ -0,0 +1,73 @@
+#include "datasets.hpp"
+#include "tree.hpp"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace
+{
+// Few attributes with few values and noisy labels, so most rows repeat, some with conflicting labels.
+std::pair<std::vector<std::vector<int>>, std::vector<int>> make_repetitive_data()
+{
+    std::mt19937 gen(17);
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::vector<int> row{static_cast<int>(gen() % 3), static_cast<int>(gen() % 4), static_cast<int>(gen() % 2), static_cast<int>(gen() % 6)};
+        target.push_back(gen() % 4 == 0 ? static_cast<int>(gen() % 3) : (row[0] + row[1] * row[2]) % 3);
+        rows.push_back(std::move(row));
+    }
+    return {rows, target};
+}
+} // namespace
+
+TEST(WeightsTest, CollapseDuplicates)
+{
+    const std::vector<std::vector<int>> rows{{1, 2}, {0, 0}, {1, 2}, {1, 2}, {0, 0}};
+    const auto unique = collapse_duplicates(rows, {0, 1, 0, 1, 1});
+
+    EXPECT_EQ(unique.rows, (std::vector<std::vector<int>>{{1, 2}, {0, 0}, {1, 2}}));
+    EXPECT_EQ(unique.target, (std::vector<int>{0, 1, 1}));
+    EXPECT_EQ(unique.weights, (std::vector<int>{2, 2, 1}));
+
+    TrainingContext ctx;
+    EXPECT_THROW(ctx.assign_weighted(unique.rows, unique.target, std::vector<int>{1}), std::invalid_argument);
+}
+
+TEST(WeightsTest, CollapsedBuildMatchesFullBuild)
+{
+    auto [car_rows, car_target] = load_car_data();
+    std::vector<std::vector<int>> rows;
+    std::vector<int> target;
+    for (int copy = 0; copy < 3; ++copy)
+    {
+        rows.insert(rows.end(), car_rows.begin(), car_rows.end());
+        target.insert(target.end(), car_target.begin(), car_target.end());
+    }
+    EXPECT_EQ(build_tree(rows, target, {.collapse_duplicates = true}), build_tree(rows, target));
+
+    std::tie(rows, target) = make_repetitive_data();
+    const auto unique = collapse_duplicates(rows, target);
+    EXPECT_LT(unique.rows.size(), rows.size() / 10);
+
+    for (auto numeric : {std::bitset<64>{}, std::bitset<64>{0b1010}})
+    {
+        for (int mss : {2, 40})
+        {
+            TrainingContext full(rows, target, numeric);
+            TrainingContext collapsed;
+            collapsed.assign_weighted(unique.rows, unique.target, unique.weights, numeric);
+
+            EXPECT_EQ(build_tree<Entropy>(collapsed, mss), build_tree<Entropy>(full, mss));
+            EXPECT_EQ(build_tree<Gini>(collapsed, mss), build_tree<Gini>(full, mss));
+            EXPECT_EQ(build_tree<GainRatio>(collapsed, mss), build_tree<GainRatio>(full, mss));
+        }
+    }
+}
+
+TEST(WeightsTest, ModeLabelIgnoresRowOrder)
+{
+    EXPECT_EQ(build_tree({{0}, {0}}, {1, 0}).leaf_label(), 0);
+    EXPECT_EQ(build_tree({{0}, {0}}, {0, 1}).leaf_label(), 0);
+}